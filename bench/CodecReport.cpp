@@ -0,0 +1,228 @@
+// Bitmap codecs report.
+//
+// Re-encodes the glyphs of IBMF fonts (e.g. the fonts generated for a corpus
+// of books) with each codec policy of BitmapEncoder (see BitmapCodec.hpp) and
+// reports, for each of them, the total size of the encoded bitmaps, the codecs
+// retained and the decoding time with RLEExtractor::retrieveBitmap(). The
+// decoded bitmaps are compared with the original ones.
+//
+// The last lines give the decoding costs measured per PK nybble, per raw byte
+// and per row-XOR delta pixel, and the corresponding DecodeCosts of the
+// MIN_DECODE policy for the device class the report is run on.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o codecReport bench/CodecReport.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: codecReport [-i <iterations>] <IBMF Font Path>...
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "IBMF/IBMFFontMod.hpp"
+
+struct Sample {
+  BitmapPtr  bitmap;
+  RLEBitmap  rle;
+  RLEMetrics rleMetrics;
+};
+
+struct Config {
+  const char  *name;
+  CodecOptions options;
+};
+
+// Encodes all the bitmaps with the options
+static void encodeAll(const std::vector<BitmapPtr> &bitmaps, const CodecOptions &options,
+                      std::vector<Sample> &samples) {
+  BitmapEncoder encoder(options);
+  samples.clear();
+  for (auto &bitmap : bitmaps) {
+    Sample sample{.bitmap = bitmap};
+    encoder.encodeBitmap(bitmap, sample.rle.pixels);
+    sample.rle.dim                 = bitmap->dim;
+    sample.rle.length              = sample.rle.pixels.size();
+    sample.rleMetrics.dynF         = encoder.getDynF();
+    sample.rleMetrics.firstIsBlack = encoder.getFirstIsBlack();
+    samples.push_back(sample);
+  }
+}
+
+// Decodes all the samples, iterations times. Returns the time in ns per glyph
+// and counts the bitmaps not identical to the original ones.
+static auto decodeAll(const std::vector<Sample> &samples, int iterations, int &mismatches)
+    -> double {
+  Bitmap bitmap;
+  bitmap.pixels = Pixels(255 * 255, 0);
+
+  mismatches = 0;
+  for (auto &sample : samples) {
+    Bitmap to;
+    to.dim    = sample.bitmap->dim;
+    to.pixels = Pixels(to.dim.width * to.dim.height, 0);
+    RLEExtractor rle;
+    if (!rle.retrieveBitmap(sample.rle, to, Pos(0, 0), sample.rleMetrics) ||
+        !(to == *sample.bitmap)) {
+      mismatches++;
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (auto &sample : samples) {
+      bitmap.dim = sample.bitmap->dim;
+      memset(bitmap.pixels.data(), 0, bitmap.dim.width * bitmap.dim.height);
+      RLEExtractor rle;
+      rle.retrieveBitmap(sample.rle, bitmap, Pos(0, 0), sample.rleMetrics);
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() * 1e9 / ((double)samples.size() * iterations);
+}
+
+auto main(int argc, char **argv) -> int {
+  int iterations = 20;
+  int argIdx     = 1;
+  if ((argc > 2) && (strcmp(argv[1], "-i") == 0)) {
+    iterations = atoi(argv[2]);
+    argIdx     = 3;
+  }
+  if (argIdx >= argc) {
+    std::cout << "Usage: " << argv[0] << " [-i <iterations>] <IBMF Font Path>..." << std::endl;
+    return -1;
+  }
+
+  // The glyphs' bitmaps of all the fonts
+
+  std::vector<BitmapPtr> bitmaps;
+  for (; argIdx < argc; argIdx++) {
+    std::ifstream        file(argv[argIdx], std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+    IBMFFontMod          font(content.data(), content.size());
+    if (!font.isInitialized()) {
+      std::cerr << "Unable to load " << argv[argIdx] << std::endl;
+      return -2;
+    }
+    for (int faceIdx = 0; faceIdx < font.getPreamble().faceCount; faceIdx++) {
+      for (int glyphCode = 0; glyphCode < font.getFaceHeader(faceIdx)->glyphCount; glyphCode++) {
+        GlyphInfoPtr    glyphInfo;
+        BitmapPtr       bitmap;
+        GlyphLigKernPtr glyphLigKern;
+        if (font.getGlyph(faceIdx, glyphCode, glyphInfo, bitmap, glyphLigKern) &&
+            (bitmap->dim.width > 0) && (bitmap->dim.height > 0)) {
+          bitmaps.push_back(bitmap);
+        }
+      }
+    }
+  }
+
+  auto options = [](CodecPolicy policy, bool xorDelta) {
+    CodecOptions codecOptions;
+    codecOptions.policy   = policy;
+    codecOptions.xorDelta = xorDelta;
+    return codecOptions;
+  };
+
+  std::vector<Config> configs = {
+      {"PK RLE (default)   ", options(CodecPolicy::PK_RLE, false)},
+      {"Raw                ", options(CodecPolicy::RAW, false)},
+      {"Min size           ", options(CodecPolicy::MIN_SIZE, false)},
+      {"Min size + XOR     ", options(CodecPolicy::MIN_SIZE, true)},
+      {"Min decode         ", options(CodecPolicy::MIN_DECODE, false)},
+      {"Min decode + XOR   ", options(CodecPolicy::MIN_DECODE, true)},
+  };
+
+  std::cout << bitmaps.size() << " glyphs, " << iterations << " iterations" << std::endl
+            << std::endl
+            << "Codec policy          Pool bytes     PK    Raw    XOR  ns/glyph  Mismatches"
+            << std::endl;
+
+  std::vector<Sample> samples;
+  int                 totalMismatches = 0;
+  for (auto &config : configs) {
+    encodeAll(bitmaps, config.options, samples);
+
+    size_t poolSize = 0;
+    int    counts[3]{0, 0, 0};
+    for (auto &sample : samples) {
+      poolSize += sample.rle.length;
+      uint8_t dynF = sample.rleMetrics.dynF;
+      counts[(dynF < 14) ? 0 : ((dynF == 14) ? 1 : 2)]++;
+    }
+
+    int    mismatches;
+    double nsPerGlyph = decodeAll(samples, iterations, mismatches);
+    totalMismatches += mismatches;
+
+    std::cout << config.name << std::setw(13) << poolSize << std::setw(7) << counts[0]
+              << std::setw(7) << counts[1] << std::setw(7) << counts[2] << std::setw(10)
+              << std::fixed << std::setprecision(1) << nsPerGlyph << std::setw(12) << mismatches
+              << std::endl;
+  }
+
+  // Decoding costs per unit, relative to the cost of a raw byte: from the glyphs
+  // the default policy PK encodes, decoded as such and as raw bitmaps, and from
+  // the glyphs sent with the row-XOR delta codec, once their PK part is deducted.
+
+  auto subset = [&](const CodecOptions &codecOptions, auto selected) {
+    std::vector<BitmapPtr> selection;
+    encodeAll(bitmaps, codecOptions, samples);
+    for (auto &sample : samples) {
+      if (selected(sample.rleMetrics.dynF)) selection.push_back(sample.bitmap);
+    }
+    return selection;
+  };
+  auto measure = [&](const std::vector<BitmapPtr> &selection, const CodecOptions &codecOptions,
+                     double &ns, double &bytes, double &pixels) {
+    int mismatches;
+    encodeAll(selection, codecOptions, samples);
+    ns     = decodeAll(samples, iterations, mismatches);
+    bytes  = 0;
+    pixels = 0;
+    for (auto &sample : samples) {
+      bytes += sample.rle.length;
+      pixels += sample.rle.dim.width * sample.rle.dim.height;
+    }
+    bytes /= samples.size();
+    pixels /= samples.size();
+  };
+
+  std::vector<BitmapPtr> pkBitmaps =
+      subset(options(CodecPolicy::PK_RLE, false), [](uint8_t dynF) { return dynF < 14; });
+  std::vector<BitmapPtr> xorBitmaps = subset(
+      options(CodecPolicy::MIN_SIZE, true),
+      [](uint8_t dynF) { return dynF == BitmapEncoder::XOR_DELTA_DYN_F; });
+
+  if (!pkBitmaps.empty()) {
+    double pkNs, pkBytes, rawNs, rawBytes, pixels;
+    measure(pkBitmaps, options(CodecPolicy::PK_RLE, false), pkNs, pkBytes, pixels);
+    measure(pkBitmaps, options(CodecPolicy::RAW, false), rawNs, rawBytes, pixels);
+    double nsPerNybble  = pkNs / (2 * pkBytes);
+    double nsPerRawByte = rawNs / rawBytes;
+    std::cout << std::endl
+              << "Measured costs: " << std::setprecision(2) << nsPerNybble << " ns/nybble, "
+              << nsPerRawByte << " ns/raw byte";
+    double perXorPixel = 0;
+    if (!xorBitmaps.empty()) {
+      double xorNs, xorBytes;
+      measure(xorBitmaps, options(CodecPolicy::MIN_SIZE, true), xorNs, xorBytes, pixels);
+      double nsPerXorPixel = (xorNs - (nsPerNybble * 2 * (xorBytes - 1))) / pixels;
+      perXorPixel          = std::max(nsPerXorPixel, 0.0) / nsPerRawByte;
+      std::cout << ", " << std::max(nsPerXorPixel, 0.0) << " ns/XOR pixel";
+    }
+    std::cout << std::endl
+              << "DecodeCosts: perNybble = " << (nsPerNybble / nsPerRawByte)
+              << ", perRawByte = 1.0, perXorPixel = " << perXorPixel << std::endl;
+  }
+
+  return totalMismatches == 0 ? 0 : 1;
+}
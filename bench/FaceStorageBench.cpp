@@ -0,0 +1,140 @@
+// IBMF font face storage benchmark.
+//
+// Measures, for IBMF fonts loaded by IBMFFontMod, the number of heap
+// allocations and the time taken by the load of the font, its save, the
+// diffing of the font with an identical copy (as done when building a font
+// modifications file) and a walk through all glyphs, with getGlyph() (copies)
+// and getGlyphView() (no copy). The glyphs are also walked by concurrent
+// readers of a lazily loaded font. The saved font is compared with the
+// original file and the walks' checksums with each other.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o faceStorageBench bench/FaceStorageBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: faceStorageBench <IBMF Font Path>...
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "IBMF/IBMFFontMod.hpp"
+
+static std::atomic<size_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *ptr = malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <IBMF Font Path>..." << std::endl;
+    return -1;
+  }
+
+  int failures = 0;
+  for (int argIdx = 1; argIdx < argc; argIdx++) {
+    std::ifstream        file(argv[argIdx], std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+    std::vector<uint8_t> copy = content;
+
+    // Runs step, reporting its allocations count and elapsed time
+    auto measure = [](const char *name, auto step) {
+      size_t start     = allocations;
+      auto   startTime = std::chrono::steady_clock::now();
+      step();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+      std::cout << "  " << name << ": " << (allocations - start) << " allocations, "
+                << (elapsed.count() * 1e3) << " ms" << std::endl;
+    };
+
+    std::cout << argv[argIdx] << ": " << content.size() << " bytes" << std::endl;
+
+    IBMFFontModPtr font, other;
+    measure("Load", [&]() {
+      font = IBMFFontModPtr(new IBMFFontMod(content.data(), content.size()));
+    });
+    other = IBMFFontModPtr(new IBMFFontMod(copy.data(), copy.size()));
+    if (!font->isInitialized() || !other->isInitialized()) {
+      std::cerr << "Unable to load " << argv[argIdx] << std::endl;
+      return -2;
+    }
+
+    std::ostringstream saved;
+    measure("Save", [&]() { font->save(saved); });
+    if (saved.str() != std::string(content.begin(), content.end())) {
+      std::cout << "  Saved font differs from the original" << std::endl;
+      failures++;
+    }
+
+    std::ostringstream report;
+    measure("Diff", [&]() { font->buildModificationsFrom(report, other, font); });
+
+    // Sum of the pixels and lig/kern steps of the glyphs of faceIdx, from first,
+    // every step glyphs
+    auto viewSum = [](const IBMFFontMod &fnt, int faceIdx, int first, int step) -> uint64_t {
+      uint64_t                sum = 0;
+      IBMFFontMod::GlyphView view;
+      for (int glyphCode = first; fnt.getGlyphView(faceIdx, glyphCode, view); glyphCode += step) {
+        for (int i = 0; i < view.dim.width * view.dim.height; i++) sum += view.pixels[i];
+        sum += view.ligCount + view.kernCount + view.glyphInfo->advance;
+      }
+      return sum;
+    };
+
+    uint64_t glyphSum = 0, viewTotal = 0, concurrentSum = 0;
+    measure("Walk, getGlyph    ", [&]() {
+      for (int faceIdx = 0; faceIdx < font->getPreamble().faceCount; faceIdx++) {
+        GlyphInfoPtr    glyphInfo;
+        BitmapPtr       bitmap;
+        GlyphLigKernPtr glyphLigKern;
+        for (int glyphCode = 0;
+             font->getGlyph(faceIdx, glyphCode, glyphInfo, bitmap, glyphLigKern); glyphCode++) {
+          for (auto pixel : bitmap->pixels) glyphSum += pixel;
+          glyphSum += glyphLigKern->ligSteps.size() + glyphLigKern->kernSteps.size() +
+                      glyphInfo->advance;
+        }
+      }
+    });
+    measure("Walk, getGlyphView", [&]() {
+      for (int faceIdx = 0; faceIdx < font->getPreamble().faceCount; faceIdx++) {
+        viewTotal += viewSum(*font, faceIdx, 0, 1);
+      }
+    });
+
+    IBMFFontMod lazyFont(content.data(), content.size(), true);
+    measure("Walk, getGlyphView, 4 readers, lazy", [&]() {
+      std::vector<uint64_t>    sums(4, 0);
+      std::vector<std::thread> readers;
+      for (int reader = 0; reader < 4; reader++) {
+        readers.emplace_back([&, reader]() {
+          for (int faceIdx = 0; faceIdx < lazyFont.getPreamble().faceCount; faceIdx++) {
+            sums[reader] += viewSum(lazyFont, faceIdx, reader, 4);
+          }
+        });
+      }
+      for (auto &reader : readers) reader.join();
+      for (auto sum : sums) concurrentSum += sum;
+    });
+
+    if ((glyphSum != viewTotal) || (glyphSum != concurrentSum)) {
+      std::cout << "  Glyph walks differ" << std::endl;
+      failures++;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
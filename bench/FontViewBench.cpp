@@ -0,0 +1,123 @@
+// IBMF font opening benchmark.
+//
+// Compares the time to get access to IBMF fonts with IBMFFontMod (the file
+// being read in memory, then loaded: all headers copied and all bitmaps
+// decoded) and with IBMFFontView (memory mapped, nothing copied). The content
+// seen through the view (face headers, glyphs' information, decoded bitmaps and
+// lig/kern steps) is compared with the one loaded by IBMFFontMod.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o fontViewBench bench/FontViewBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: fontViewBench [-i <iterations>] <IBMF Font Path>...
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "IBMF/IBMFFontMod.hpp"
+#include "IBMF/IBMFFontView.hpp"
+
+static auto readFile(const char *filePath) -> std::vector<uint8_t> {
+  std::ifstream file(filePath, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+}
+
+// Counts the differences between the font loaded by IBMFFontMod and the view
+static auto compare(IBMFFontMod &font, IBMFFontView &view) -> int {
+  int diffs = 0;
+  if (font.getPreamble().faceCount != view.getFaceCount()) return 1;
+  if (view.getFontFormat() == FontFormat::BACKUP) return 0; // Glyphs not compared
+
+  for (int faceIdx = 0; faceIdx < view.getFaceCount(); faceIdx++) {
+    const IBMFFontView::FaceView *face = view.getFace(faceIdx);
+    if (memcmp(font.getFaceHeader(faceIdx).get(), face->header, sizeof(FaceHeader)) != 0) {
+      diffs++;
+      continue;
+    }
+    for (GlyphCode glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
+      GlyphInfoPtr    glyphInfo;
+      BitmapPtr       bitmap;
+      GlyphLigKernPtr glyphLigKern;
+      Bitmap          viewBitmap;
+      if (!font.getGlyph(faceIdx, glyphCode, glyphInfo, bitmap, glyphLigKern) ||
+          !view.getBitmap(faceIdx, glyphCode, viewBitmap) ||
+          !(*glyphInfo == face->glyphs[glyphCode]) || !(*bitmap == viewBitmap)) {
+        diffs++;
+        continue;
+      }
+
+      // The glyph's lig/kern program, as decoded by IBMFFontMod::load()
+      size_t stepCount = 0;
+      int    lkIdx     = face->glyphs[glyphCode].ligKernPgmIndex;
+      if ((lkIdx != 255) && (lkIdx < (int)face->ligKernSteps.size())) {
+        if (face->ligKernSteps[lkIdx].b.goTo.isAGoTo && face->ligKernSteps[lkIdx].b.kern.isAKern) {
+          lkIdx = face->ligKernSteps[lkIdx].b.goTo.displacement;
+        }
+        do {
+          stepCount++;
+        } while (!face->ligKernSteps[lkIdx++].a.data.stop);
+      }
+      if (stepCount != (glyphLigKern->ligSteps.size() + glyphLigKern->kernSteps.size())) diffs++;
+    }
+  }
+  return diffs;
+}
+
+auto main(int argc, char **argv) -> int {
+  int iterations = 20;
+  int argIdx     = 1;
+  if ((argc > 2) && (strcmp(argv[1], "-i") == 0)) {
+    iterations = atoi(argv[2]);
+    argIdx     = 3;
+  }
+  if (argIdx >= argc) {
+    std::cout << "Usage: " << argv[0] << " [-i <iterations>] <IBMF Font Path>..." << std::endl;
+    return -1;
+  }
+
+  int totalDiffs = 0;
+  for (; argIdx < argc; argIdx++) {
+    const char *filePath = argv[argIdx];
+
+    std::vector<uint8_t> content = readFile(filePath);
+    IBMFFontMod          font(content.data(), content.size());
+    IBMFFontView         view(filePath);
+    if (!font.isInitialized() || !view.isOpen()) {
+      std::cerr << "Unable to load " << filePath << std::endl;
+      return -2;
+    }
+    int diffs = compare(font, view);
+    totalDiffs += diffs;
+
+    auto     start = std::chrono::steady_clock::now();
+    uint64_t sum   = 0;
+    for (int i = 0; i < iterations; i++) {
+      std::vector<uint8_t> data = readFile(filePath);
+      IBMFFontMod          loaded(data.data(), data.size());
+      sum += loaded.getFaceHeader(0)->glyphCount;
+    }
+    std::chrono::duration<double> modElapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      IBMFFontView opened(filePath);
+      sum += opened.getFace(0)->header->glyphCount;
+    }
+    std::chrono::duration<double> viewElapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << filePath << ": " << content.size() << " bytes, " << diffs
+              << " diffs, IBMFFontMod " << (modElapsed.count() * 1e6 / iterations)
+              << " us, IBMFFontView " << (viewElapsed.count() * 1e6 / iterations) << " us ("
+              << sum << ")" << std::endl;
+  }
+
+  return totalDiffs == 0 ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// Hex glyph decoding and cropping micro-benchmark.
+//
+// Compares the row based decoder (IBMFHexImport::readGlyphRows() + readOneGlyph())
+// with the former per character routine, on every line of a GNU Unifont hex file.
+// Results of both are also compared to insure they are identical.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o hexDecodeBench bench/HexDecodeBench.cpp \
+//       src/IBMF/*.cpp src/Misc/MappedFile.cpp src/Misc/log.cpp
+//
+// Usage: hexDecodeBench <HEX Font Path> [iterations]
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "IBMF/IBMFHexImport.hpp"
+#include "Misc/MappedFile.hpp"
+
+struct Line {
+  char32_t    codePoint;
+  const char *glyph;
+  const char *end;
+};
+
+struct Result {
+  Dim    dim;
+  int8_t vOffset;
+  Pixels pixels;
+};
+
+// The decoding and cropping routine as it was before the row based decoder.
+static auto legacyDecode(const Line &line, Result &result) -> bool {
+  auto hex = [](char a) -> uint8_t { return ((a >= '0') && (a <= '9')) ? a - '0' : a - 'A' + 10; };
+
+  std::vector<uint8_t> bytes;
+  for (const char *p = line.glyph; (p + 1) < line.end; p += 2) {
+    bytes.push_back((hex(p[0]) << 4) + hex(p[1]));
+  }
+
+  int byteWidth  = (bytes.size() == 16) ? 1 : 2;
+  int byteHeight = 16;
+
+  result.pixels.clear();
+
+  if ((byteWidth * byteHeight) != bytes.size()) return false;
+
+  int firstRow, lastRow, firstCol, lastCol;
+  if (byteWidth == 1) {
+    for (firstRow = 0; firstRow < 16; firstRow++) {
+      if (bytes[firstRow] != 0) break;
+    }
+    if (firstRow >= 16) goto spaceCode;
+    for (lastRow = 15; lastRow >= 0; lastRow--) {
+      if (bytes[lastRow] != 0) break;
+    }
+  } else {
+    for (firstRow = 0; firstRow < 16; firstRow++) {
+      if ((bytes[firstRow << 1] != 0) || (bytes[(firstRow << 1) + 1] != 0)) break;
+    }
+    if (firstRow >= 16) goto spaceCode;
+    for (lastRow = 15; lastRow >= 0; lastRow--) {
+      if ((bytes[lastRow << 1] != 0) || (bytes[(lastRow << 1) + 1] != 0)) break;
+    }
+  }
+
+  if (byteWidth == 1) {
+    uint8_t mask = 0x80;
+    firstCol     = 0;
+    for (int j = 0; j < 7; j++) {
+      for (int i = firstRow; i <= lastRow; i++) {
+        if (bytes[i] & mask) goto end1;
+      }
+      mask >>= 1;
+      firstCol += 1;
+    }
+end1:
+    mask    = 0x01;
+    lastCol = 7;
+    for (int j = 0; j < 7; j++) {
+      for (int i = firstRow; i <= lastRow; i++) {
+        if (bytes[i] & mask) goto end2;
+      }
+      mask <<= 1;
+      lastCol -= 1;
+    }
+  } else {
+    uint8_t mask = 0x80;
+    firstCol     = 0;
+    for (int j = 0; j < 15; j++) {
+      for (int i = firstRow; i <= lastRow; i++) {
+        if (bytes[(i << 1) + (j >> 3)] & mask) goto end3;
+      }
+      mask >>= 1;
+      if (mask == 0) mask = 0x80;
+      firstCol += 1;
+    }
+end3:
+    mask    = 0x01;
+    lastCol = 15;
+    for (int j = 15; j >= 0; j--) {
+      for (int i = firstRow; i <= lastRow; i++) {
+        if (bytes[(i << 1) + (j >> 3)] & mask) goto end4;
+      }
+      mask <<= 1;
+      if (mask == 0) mask = 0x01;
+      lastCol -= 1;
+    }
+  }
+
+end2:
+end4:
+  {
+    result.dim     = Dim(lastCol - firstCol + 1, lastRow - firstRow + 1);
+    result.vOffset = 14 - firstRow;
+
+    uint8_t *buff  = bytes.data() + (firstRow * byteWidth);
+    for (int row = firstRow; row <= lastRow; row++) {
+      uint8_t mask = 0x80 >> (firstCol & 7);
+      for (int col = firstCol; col <= lastCol; col++) {
+        result.pixels.push_back(((buff[col >> 3] & mask) == 0) ? 0 : 0xFF);
+        mask >>= 1;
+        if (mask == 0) mask = 0x80;
+      }
+      buff += byteWidth;
+    }
+  }
+  return true;
+
+spaceCode:
+  result.dim     = Dim(0, 0);
+  result.vOffset = 0;
+  return true;
+}
+
+static auto rowsDecode(const IBMFHexImport &hexImport, const Line &line, BitmapPtr &bitmap,
+                       Result &result) -> bool {
+  IBMFHexImport::HexGlyph hexGlyph;
+  int8_t                  hOffset;
+  uint16_t                advance;
+
+  hexGlyph.codePoint = line.codePoint;
+  if (!IBMFHexImport::readGlyphRows(line.glyph, line.end, hexGlyph)) return false;
+  if (!hexImport.readOneGlyph(hexGlyph, bitmap, hOffset, result.vOffset, advance)) return false;
+  result.dim = bitmap->dim;
+  return true;
+}
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <HEX Font Path> [iterations]" << std::endl;
+    return -1;
+  }
+  int iterations = (argc > 2) ? atoi(argv[2]) : 20;
+
+  MappedFile hexFile;
+  if (!hexFile.open(argv[1])) return -2;
+
+  std::vector<Line> lines;
+  for (const char *ptr = hexFile.begin(); ptr < hexFile.end();) {
+    const char *lineEnd = (const char *)memchr(ptr, '\n', hexFile.end() - ptr);
+    if (lineEnd == nullptr) lineEnd = hexFile.end();
+    const char *colon = (const char *)memchr(ptr, ':', lineEnd - ptr);
+    if (colon != nullptr) {
+      lines.push_back(Line{(char32_t)strtoul(ptr, nullptr, 16), colon + 1, lineEnd});
+    }
+    ptr = lineEnd + 1;
+  }
+
+  IBMFHexImport hexImport;
+  BitmapPtr     bitmap = BitmapPtr(new Bitmap);
+  Result        legacy, rows;
+
+  // Both routines must give the same result
+  int mismatches = 0;
+  for (auto &line : lines) {
+    bool ok1 = legacyDecode(line, legacy);
+    bool ok2 = rowsDecode(hexImport, line, bitmap, rows);
+    if ((ok1 != ok2) || (ok1 && (!(legacy.dim == rows.dim) || (legacy.vOffset != rows.vOffset) ||
+                                 (legacy.pixels != bitmap->pixels)))) {
+      if (mismatches++ < 10) {
+        std::cout << "Mismatch for U+" << std::hex << +line.codePoint << std::dec << std::endl;
+      }
+    }
+  }
+
+  auto run = [&](const char *name, auto decode) -> double {
+    auto     start = std::chrono::steady_clock::now();
+    uint64_t sum   = 0;
+    for (int i = 0; i < iterations; i++) {
+      for (auto &line : lines) {
+        sum += decode(line);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double nsPerGlyph = elapsed.count() * 1e9 / ((double)lines.size() * iterations);
+    std::cout << name << ": " << elapsed.count() << " s, " << nsPerGlyph << " ns/glyph (" << sum
+              << ")" << std::endl;
+    return nsPerGlyph;
+  };
+
+  std::cout << lines.size() << " glyphs, " << iterations << " iterations, " << mismatches
+            << " mismatches" << std::endl;
+
+  double t1 = run("Legacy decoder", [&](const Line &line) -> uint64_t {
+    legacyDecode(line, legacy);
+    return legacy.pixels.size();
+  });
+  double t2 = run("Rows decoder  ", [&](const Line &line) -> uint64_t {
+    rowsDecode(hexImport, line, bitmap, rows);
+    return bitmap->pixels.size();
+  });
+
+  std::cout << "Speedup: " << (t1 / t2) << "x" << std::endl;
+
+  return mismatches == 0 ? 0 : 1;
+}
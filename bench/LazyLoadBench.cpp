@@ -0,0 +1,129 @@
+// IBMF font lazy loading benchmark.
+//
+// Loads IBMF fonts with IBMFFontMod, eagerly (all bitmaps decoded at load
+// time) and lazily (bitmaps decoded on demand by getGlyph(), through a bitmap
+// cache of various budgets), then retrieves all glyphs twice. The peak heap
+// usage (the file content excluded), the load and retrieval times and the
+// bitmap cache statistics are reported. The glyphs retrieved lazily are
+// compared with the ones loaded eagerly.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o lazyLoadBench bench/LazyLoadBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: lazyLoadBench <IBMF Font Path>...
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <vector>
+
+#include "IBMF/IBMFFontMod.hpp"
+
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+void *operator new(size_t size) {
+  if (void *ptr = malloc(size)) {
+    liveBytes += malloc_usable_size(ptr);
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept {
+  if (ptr != nullptr) liveBytes -= malloc_usable_size(ptr);
+  free(ptr);
+}
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
+struct Sample {
+  GlyphInfoPtr    glyphInfo;
+  BitmapPtr       bitmap;
+  GlyphLigKernPtr glyphLigKern;
+};
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <IBMF Font Path>..." << std::endl;
+    return -1;
+  }
+
+  int totalDiffs = 0;
+  for (int argIdx = 1; argIdx < argc; argIdx++) {
+    std::ifstream        file(argv[argIdx], std::ios::binary);
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                                 std::istreambuf_iterator<char>());
+
+    // Reference glyphs, loaded eagerly
+    std::vector<Sample> reference;
+    {
+      IBMFFontMod font(content.data(), content.size());
+      if (!font.isInitialized()) {
+        std::cerr << "Unable to load " << argv[argIdx] << std::endl;
+        return -2;
+      }
+      for (int faceIdx = 0; faceIdx < font.getPreamble().faceCount; faceIdx++) {
+        for (int glyphCode = 0; glyphCode < font.getFaceHeader(faceIdx)->glyphCount; glyphCode++) {
+          Sample glyph;
+          font.getGlyph(faceIdx, glyphCode, glyph.glyphInfo, glyph.bitmap, glyph.glyphLigKern);
+          reference.push_back(glyph);
+        }
+      }
+    }
+
+    std::cout << argv[argIdx] << ": " << content.size() << " bytes, " << reference.size()
+              << " glyphs" << std::endl;
+
+    auto run = [&](const char *name, bool lazy, size_t budget) {
+      size_t baseBytes = liveBytes;
+      peakBytes        = liveBytes;
+      int    diffs     = 0;
+
+      auto         start = std::chrono::steady_clock::now();
+      IBMFFontMod *font  = new IBMFFontMod(content.data(), content.size(), lazy);
+      font->setBitmapCacheBudget(budget);
+      std::chrono::duration<double> loadElapsed = std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      for (int pass = 0; pass < 2; pass++) {
+        size_t idx = 0;
+        for (int faceIdx = 0; faceIdx < font->getPreamble().faceCount; faceIdx++) {
+          for (int glyphCode = 0; glyphCode < font->getFaceHeader(faceIdx)->glyphCount;
+               glyphCode++, idx++) {
+            Sample glyph;
+            font->getGlyph(faceIdx, glyphCode, glyph.glyphInfo, glyph.bitmap, glyph.glyphLigKern);
+            if (!(*glyph.bitmap == *reference[idx].bitmap) ||
+                !(*glyph.glyphInfo == *reference[idx].glyphInfo)) {
+              diffs++;
+            }
+          }
+        }
+      }
+      std::chrono::duration<double> getElapsed = std::chrono::steady_clock::now() - start;
+
+      const BitmapCache &cache = font->getBitmapCache();
+      std::cout << "  " << name << ": peak " << ((peakBytes - baseBytes) / 1024) << " KB, load "
+                << (loadElapsed.count() * 1e3) << " ms, 2 x getGlyph "
+                << (getElapsed.count() * 1e3) << " ms, cache " << (cache.getSize() / 1024)
+                << " KB (" << cache.getHits() << " hits, " << cache.getMisses() << " misses), "
+                << diffs << " diffs" << std::endl;
+
+      delete font;
+      totalDiffs += diffs;
+    };
+
+    run("Eager            ", false, BitmapCache::DEFAULT_BUDGET);
+    run("Lazy, no cache   ", true, 0);
+    run("Lazy, 64 KB cache", true, 64 * 1024);
+    run("Lazy, 4 MB cache ", true, BitmapCache::DEFAULT_BUDGET);
+  }
+
+  return totalDiffs == 0 ? 0 : 1;
+}
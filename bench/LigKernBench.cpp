@@ -0,0 +1,143 @@
+// IBMF font lig/kern table preparation stress benchmark.
+//
+// Gives synthetic kerning programs to the glyphs of an IBMF font, then saves
+// it with IBMFFontMod: the save time is dominated by the preparation of the
+// face's lig/kern table (programs deduplication and relocation of the ones
+// starting beyond index 254). The programs mimic real kerning tables: glyphs
+// of the same class share the same program, and the programs of a class are
+// built from a few common tails, such that many are suffixes of others. As
+// all programs must be reachable from the first 255 entries of the table,
+// the number of classes is kept under that limit. The save time of the font
+// without kerning is given as a reference. The saved font is reloaded and
+// its glyphs' lig/kern programs compared with the ones given.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o ligKernBench bench/LigKernBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: ligKernBench [-g <kerned glyphs>] [-c <classes>] [-o <Output Path>] <IBMF Font Path>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "IBMF/IBMFFontMod.hpp"
+
+// Deterministic pseudo-random generator, such that the runs are comparable
+static uint32_t seed = 12345;
+static auto nextRandom(uint32_t range) -> uint32_t {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % range;
+}
+
+auto main(int argc, char **argv) -> int {
+  int         kernedGlyphs = 5000;
+  int         classCount   = 200;
+  const char *outputPath   = nullptr;
+  int         argIdx       = 1;
+  while ((argIdx + 1 < argc) && (argv[argIdx][0] == '-')) {
+    if (strcmp(argv[argIdx], "-g") == 0) kernedGlyphs = atoi(argv[argIdx + 1]);
+    if (strcmp(argv[argIdx], "-c") == 0) classCount = atoi(argv[argIdx + 1]);
+    if (strcmp(argv[argIdx], "-o") == 0) outputPath = argv[argIdx + 1];
+    argIdx += 2;
+  }
+  if (argIdx >= argc) {
+    std::cout << "Usage: " << argv[0]
+              << " [-g <kerned glyphs>] [-c <classes>] [-o <Output Path>] <IBMF Font Path>"
+              << std::endl;
+    return -1;
+  }
+
+  std::ifstream        file(argv[argIdx], std::ios::binary);
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+  IBMFFontMod          font(content.data(), content.size());
+  if (!font.isInitialized()) {
+    std::cerr << "Unable to load " << argv[argIdx] << std::endl;
+    return -2;
+  }
+
+  int glyphCount = font.getFaceHeader(0)->glyphCount;
+  kernedGlyphs   = std::min(kernedGlyphs, glyphCount);
+
+  // Saves the font in out, returning the elapsed time in ms
+  auto timedSave = [&font](std::ostringstream &out) -> double {
+    auto start = std::chrono::steady_clock::now();
+    if (!font.save(out)) {
+      std::cerr << "Unable to save the font (error " << font.getLastError() << ")" << std::endl;
+      exit(-3);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e3;
+  };
+
+  std::ostringstream reference;
+  double             referenceTime = timedSave(reference);
+
+  // Common tails, each class program being a few specific steps followed by
+  // one of them
+  std::vector<GlyphKernSteps> tails(32);
+  for (auto &tail : tails) {
+    int length = 4 + nextRandom(40);
+    for (int i = 0; i < length; i++) {
+      tail.push_back(GlyphKernStep{.nextGlyphCode = static_cast<GlyphCode>(nextRandom(glyphCount)),
+                                   .kern = static_cast<FIX16>(nextRandom(256) - 128)});
+    }
+  }
+  std::vector<GlyphKernSteps> classes(std::max(1, classCount));
+  for (auto &steps : classes) {
+    int length = nextRandom(6);
+    for (int i = 0; i < length; i++) {
+      steps.push_back(GlyphKernStep{.nextGlyphCode = static_cast<GlyphCode>(nextRandom(glyphCount)),
+                                    .kern = static_cast<FIX16>(nextRandom(256) - 128)});
+    }
+    const GlyphKernSteps &tail = tails[nextRandom(tails.size())];
+    steps.insert(steps.end(), tail.begin(), tail.end());
+  }
+
+  size_t programSteps = 0;
+  for (int i = 0; i < kernedGlyphs; i++) {
+    GlyphCode       glyphCode = nextRandom(glyphCount);
+    GlyphInfoPtr    glyphInfo;
+    BitmapPtr       bitmap;
+    GlyphLigKernPtr glyphLigKern;
+    font.getGlyph(0, glyphCode, glyphInfo, bitmap, glyphLigKern);
+    glyphLigKern->kernSteps = classes[nextRandom(classes.size())];
+    programSteps += glyphLigKern->kernSteps.size();
+    font.saveGlyph(0, glyphCode, glyphInfo, bitmap, glyphLigKern);
+  }
+
+  std::ostringstream out;
+  double             saveTime = timedSave(out);
+
+  std::string          result = out.str();
+  std::vector<uint8_t> savedContent(result.begin(), result.end());
+  IBMFFontMod          savedFont(savedContent.data(), savedContent.size());
+  int                  diffs = savedFont.isInitialized() ? 0 : 1;
+  for (int glyphCode = 0; (diffs == 0) && (glyphCode < glyphCount); glyphCode++) {
+    GlyphInfoPtr    glyphInfo;
+    BitmapPtr       bitmap;
+    GlyphLigKernPtr glyphLigKern, savedGlyphLigKern;
+    font.getGlyph(0, glyphCode, glyphInfo, bitmap, glyphLigKern);
+    savedFont.getGlyph(0, glyphCode, glyphInfo, bitmap, savedGlyphLigKern);
+    if (!(*glyphLigKern == *savedGlyphLigKern)) diffs++;
+  }
+
+  std::cout << argv[argIdx] << ": " << kernedGlyphs << " kerned glyphs, " << programSteps
+            << " program steps, " << font.getFaceHeader(0)->ligKernStepCount
+            << " lig/kern steps saved, save " << saveTime << " ms (" << referenceTime
+            << " ms without kerning), " << diffs << " diffs" << std::endl;
+
+  if (outputPath != nullptr) {
+    std::ofstream output(outputPath, std::ios::binary);
+    output << result;
+  }
+
+  return diffs == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// IBMF font lig/kern pair lookup benchmark.
+//
+// Calls IBMFFontMod::ligKern() for each pair of consecutive glyphs of the
+// text of an EPub book, as a layout engine does, first scanning the glyphs'
+// lig/kern steps, then through the index built by buildLigKernIndex(). As the
+// fonts generated from the HEX fonts have no kerning, the glyphs most often
+// followed by another one in the book are first given kerning steps, one for
+// each of their most frequent followers. The time per pair and the index
+// build time are reported, and the results of both lookups are compared.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o ligKernLookupBench bench/LigKernLookupBench.cpp \
+//       src/EPub/*.cpp src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: ligKernLookupBench [-k <kerned glyphs>] [-p <pairs per glyph>] <IBMF Font Path> <EPub file path>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include "EPub/EPubFile.hpp"
+#include "IBMF/IBMFFontMod.hpp"
+#include "IBMF/UTF8Iterator.hpp"
+
+struct Result {
+  GlyphCode glyphCode2;
+  FIX16     kern;
+  bool      kernPairPresent;
+  bool      ligature;
+  bool      operator==(const Result &other) const {
+    return (glyphCode2 == other.glyphCode2) && (kern == other.kern) &&
+           (kernPairPresent == other.kernPairPresent) && (ligature == other.ligature);
+  }
+};
+
+auto main(int argc, char **argv) -> int {
+  int kernedGlyphs = 1000;
+  int pairsPerGlyph = 64;
+  int argIdx       = 1;
+  while ((argIdx + 2 < argc) && (argv[argIdx][0] == '-')) {
+    if (strcmp(argv[argIdx], "-k") == 0) kernedGlyphs = atoi(argv[argIdx + 1]);
+    if (strcmp(argv[argIdx], "-p") == 0) pairsPerGlyph = atoi(argv[argIdx + 1]);
+    argIdx += 2;
+  }
+  if (argIdx + 1 >= argc) {
+    std::cout << "Usage: " << argv[0]
+              << " [-k <kerned glyphs>] [-p <pairs per glyph>] <IBMF Font Path> <EPub file path>"
+              << std::endl;
+    return -1;
+  }
+
+  std::ifstream        file(argv[argIdx], std::ios::binary);
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+  IBMFFontMod          font(content.data(), content.size());
+  if (!font.isInitialized()) {
+    std::cerr << "Unable to load " << argv[argIdx] << std::endl;
+    return -2;
+  }
+  int glyphCount = font.getFaceHeader(0)->glyphCount;
+
+  // The book's text, as glyph codes. Characters absent from the font break
+  // the pairs sequence, as do the ends of the text nodes.
+  EPubFile ePub(argv[argIdx + 1]);
+  if (!ePub.isOpen()) {
+    std::cerr << "Unable to open " << argv[argIdx + 1] << std::endl;
+    return -2;
+  }
+
+  struct Walker : pugi::xml_tree_walker {
+    IBMFFontMod                           *font;
+    int                                    glyphCount;
+    std::vector<std::pair<GlyphCode, GlyphCode>> *pairs;
+
+    auto for_each(pugi::xml_node &node) -> bool override {
+      if (node.type() == pugi::xml_node_type::node_pcdata) {
+        const std::string data     = node.value();
+        auto              iter     = UTF8Iterator(data);
+        int               previous = -1;
+        while (iter != data.end()) {
+          GlyphCode glyphCode = font->translate(*iter++);
+          if (glyphCode < glyphCount) {
+            if (previous != -1) pairs->push_back({previous, glyphCode});
+            previous = glyphCode;
+          } else {
+            previous = -1;
+          }
+        }
+      }
+      return true;
+    }
+  } walker;
+
+  std::vector<std::pair<GlyphCode, GlyphCode>> pairs;
+  walker.font       = &font;
+  walker.glyphCount = glyphCount;
+  walker.pairs      = &pairs;
+  for (int spineIdx = 0; spineIdx < ePub.getSpineCount(); spineIdx++) {
+    pugi::xml_document &doc = ePub.getXHTMLFile(ePub.getSpine(spineIdx).item->href);
+    if (doc) doc.traverse(walker);
+  }
+  if (pairs.empty()) {
+    std::cerr << "No text found in " << argv[argIdx + 1] << std::endl;
+    return -2;
+  }
+
+  // Kerning of the most frequent pairs, keyed by the main code of the next glyph
+  std::vector<std::map<GlyphCode, int>> followers(glyphCount);
+  std::vector<int>                      frequencies(glyphCount, 0);
+  for (auto [glyphCode1, glyphCode2] : pairs) {
+    GlyphInfoPtr    glyphInfo;
+    BitmapPtr       bitmap;
+    GlyphLigKernPtr glyphLigKern;
+    font.getGlyph(0, glyphCode2, glyphInfo, bitmap, glyphLigKern);
+    followers[glyphCode1][glyphInfo->mainCode]++;
+    frequencies[glyphCode1]++;
+  }
+  std::vector<GlyphCode> byFrequency;
+  for (int glyphCode = 0; glyphCode < glyphCount; glyphCode++) {
+    if (frequencies[glyphCode] > 0) byFrequency.push_back(glyphCode);
+  }
+  std::sort(byFrequency.begin(), byFrequency.end(),
+            [&](GlyphCode a, GlyphCode b) { return frequencies[a] > frequencies[b]; });
+  if ((int)byFrequency.size() > kernedGlyphs) byFrequency.resize(kernedGlyphs);
+
+  int kernSteps = 0;
+  for (auto glyphCode : byFrequency) {
+    std::vector<std::pair<int, GlyphCode>> nexts;
+    for (auto [mainCode, count] : followers[glyphCode]) nexts.push_back({-count, mainCode});
+    std::sort(nexts.begin(), nexts.end());
+    if ((int)nexts.size() > pairsPerGlyph) nexts.resize(pairsPerGlyph);
+
+    GlyphInfoPtr    glyphInfo;
+    BitmapPtr       bitmap;
+    GlyphLigKernPtr glyphLigKern;
+    font.getGlyph(0, glyphCode, glyphInfo, bitmap, glyphLigKern);
+    glyphLigKern->kernSteps.clear();
+    for (auto [count, mainCode] : nexts) {
+      // Negative values exercise the FIX14 sign extension
+      glyphLigKern->kernSteps.push_back(
+          GlyphKernStep{.nextGlyphCode = mainCode,
+                        .kern          = static_cast<FIX16>(((mainCode * 37) % 512) - 256)});
+    }
+    kernSteps += glyphLigKern->kernSteps.size();
+    font.saveGlyph(0, glyphCode, glyphInfo, bitmap, glyphLigKern);
+  }
+
+  // Lookups of all pairs, repeated to get at least a few million of them
+  int repeat = std::max<int>(1, 4000000 / pairs.size());
+
+  auto lookups = [&](std::vector<Result> &results) -> double {
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < repeat; pass++) {
+      for (size_t i = 0; i < pairs.size(); i++) {
+        Result result;
+        result.glyphCode2 = pairs[i].second;
+        result.ligature   = font.ligKern(0, pairs[i].first, &result.glyphCode2, &result.kern,
+                                         &result.kernPairPresent);
+        results[i]        = result;
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / (double(repeat) * pairs.size());
+  };
+
+  std::vector<Result> scanned(pairs.size()), indexed(pairs.size());
+  double              scanTime = lookups(scanned);
+
+  auto start = std::chrono::steady_clock::now();
+  font.buildLigKernIndex();
+  std::chrono::duration<double> buildElapsed = std::chrono::steady_clock::now() - start;
+
+  double indexTime = lookups(indexed);
+
+  int diffs = 0, kerned = 0, ligatures = 0;
+  for (size_t i = 0; i < pairs.size(); i++) {
+    if (!(scanned[i] == indexed[i])) diffs++;
+    if (scanned[i].kernPairPresent) kerned++;
+    if (scanned[i].ligature) ligatures++;
+  }
+
+  std::cout << argv[argIdx + 1] << ": " << pairs.size() << " pairs (" << kerned << " kerned, "
+            << ligatures << " ligatures), " << byFrequency.size() << " kerned glyphs, "
+            << kernSteps << " kern steps" << std::endl
+            << "  Scan : " << scanTime << " ns/pair" << std::endl
+            << "  Index: " << indexTime << " ns/pair, built in " << (buildElapsed.count() * 1e3)
+            << " ms" << std::endl
+            << "  " << diffs << " diffs" << std::endl;
+
+  return diffs == 0 ? 0 : 1;
+}
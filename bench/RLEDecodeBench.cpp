@@ -0,0 +1,269 @@
+// RLE bitmap decoding micro-benchmark.
+//
+// Encodes every glyph of a GNU Unifont hex file with the RLEGenerator, then
+// measures the decoding throughput of RLEExtractor::retrieveBitmap(), as done
+// by IBMFFontMod::load(). The decoded bitmaps are compared with the original
+// ones, on the glyphs and on random bitmaps (with and without an offset in a
+// larger bitmap), to insure the decoder gives back exactly what was encoded.
+// The same is done for the spans decoder (RLEExtractor::retrieveSpans()) and
+// the one bit per pixel blitter (RLEExtractor::blitOneBit()), the latter being
+// also measured while painting glyphs on a page sized frame buffer.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o rleDecodeBench bench/RLEDecodeBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: rleDecodeBench <HEX Font Path> [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "IBMF/IBMFHexImport.hpp"
+#include "Misc/MappedFile.hpp"
+
+struct Sample {
+  BitmapPtr  bitmap;
+  RLEBitmap  rle;
+  RLEMetrics rleMetrics;
+};
+
+static auto encode(BitmapPtr bitmap) -> Sample {
+  RLEGenerator gen;
+  gen.encodeBitmap(bitmap);
+
+  Sample sample{.bitmap = bitmap};
+  sample.rle.pixels              = *gen.getData();
+  sample.rle.dim                 = bitmap->dim;
+  sample.rle.length              = gen.getData()->size();
+  sample.rleMetrics.dynF         = gen.getDynF();
+  sample.rleMetrics.firstIsBlack = gen.getFirstIsBlack();
+  return sample;
+}
+
+// Decodes the sample at offset in a larger bitmap and compares the result with
+// the original, the surrounding pixels having to stay untouched.
+static auto roundTrip(const Sample &sample, Pos offset, Dim margin) -> bool {
+  const Dim &dim = sample.bitmap->dim;
+  Bitmap     to;
+  to.dim    = Dim(dim.width + offset.x + margin.width, dim.height + offset.y + margin.height);
+  to.pixels = Pixels(to.dim.width * to.dim.height, 0);
+
+  RLEExtractor rle;
+  if (!rle.retrieveBitmap(sample.rle, to, offset, sample.rleMetrics)) return false;
+
+  for (int row = 0; row < to.dim.height; row++) {
+    for (int col = 0; col < to.dim.width; col++) {
+      int     fromRow  = row - offset.y;
+      int     fromCol  = col - offset.x;
+      uint8_t expected = 0;
+      if ((fromRow >= 0) && (fromRow < dim.height) && (fromCol >= 0) && (fromCol < dim.width)) {
+        expected = sample.bitmap->pixels[(fromRow * dim.width) + fromCol];
+      }
+      if (to.pixels[(row * to.dim.width) + col] != expected) return false;
+    }
+  }
+  return true;
+}
+
+// Rebuilds the bitmap from its spans
+static auto spansRoundTrip(const Sample &sample) -> bool {
+  const Dim &dim = sample.bitmap->dim;
+  Pixels     pixels(dim.width * dim.height, 0);
+  int        lastRow = -1;
+  bool       ordered = true;
+
+  RLEExtractor rle;
+  if (!rle.retrieveSpans(sample.rle, sample.rleMetrics,
+                         [&](uint32_t row, uint32_t fromCol, uint32_t toCol) {
+                           if ((int)row < lastRow) ordered = false;
+                           lastRow = row;
+                           memset(&pixels[(row * dim.width) + fromCol], 0xFF, toCol - fromCol);
+                         })) {
+    return false;
+  }
+  return ordered && (pixels == sample.bitmap->pixels);
+}
+
+// Paints the sample in a small frame buffer at (x, y), possibly partly outside
+// of it, and compares the result with the original bitmap
+static auto blitRoundTrip(const Sample &sample, int x, int y) -> bool {
+  const Dim &dim     = sample.bitmap->dim;
+  uint32_t   width   = 90;
+  uint32_t   height  = 50;
+  uint32_t   rowSize = (width + 7) >> 3;
+  Pixels     frameBuffer(rowSize * height, BLACK_ONE_BIT ? 0 : 0xFF);
+
+  RLEExtractor rle;
+  if (!rle.blitOneBit(sample.rle, sample.rleMetrics, frameBuffer.data(), width, height, x, y)) {
+    return false;
+  }
+  for (int row = 0; row < (int)height; row++) {
+    for (int col = 0; col < (int)width; col++) {
+      int  fromRow = row - y;
+      int  fromCol = col - x;
+      bool black   = (fromRow >= 0) && (fromRow < dim.height) && (fromCol >= 0) &&
+                   (fromCol < dim.width) && sample.bitmap->pixels[(fromRow * dim.width) + fromCol];
+      bool bit     = frameBuffer[(row * rowSize) + (col >> 3)] & (0x80 >> (col & 7));
+      if (black != (bit == (bool)BLACK_ONE_BIT)) return false;
+    }
+  }
+  return true;
+}
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <HEX Font Path> [iterations]" << std::endl;
+    return -1;
+  }
+  int iterations = (argc > 2) ? atoi(argv[2]) : 10;
+
+  MappedFile hexFile;
+  if (!hexFile.open(argv[1])) return -2;
+
+  IBMFHexImport       hexImport;
+  std::vector<Sample> glyphs;
+
+  for (const char *ptr = hexFile.begin(); ptr < hexFile.end();) {
+    const char *lineEnd = (const char *)memchr(ptr, '\n', hexFile.end() - ptr);
+    if (lineEnd == nullptr) lineEnd = hexFile.end();
+    const char *colon = (const char *)memchr(ptr, ':', lineEnd - ptr);
+
+    IBMFHexImport::HexGlyph hexGlyph;
+    int8_t                  hOffset, vOffset;
+    uint16_t                advance;
+    BitmapPtr               bitmap = BitmapPtr(new Bitmap);
+
+    if (colon != nullptr) {
+      hexGlyph.codePoint = (char32_t)strtoul(ptr, nullptr, 16);
+      if (IBMFHexImport::readGlyphRows(colon + 1, lineEnd, hexGlyph) &&
+          hexImport.readOneGlyph(hexGlyph, bitmap, hOffset, vOffset, advance) &&
+          (bitmap->dim.width > 0)) {
+        glyphs.push_back(encode(bitmap));
+      }
+    }
+    ptr = lineEnd + 1;
+  }
+
+  // Random bitmaps of all widths up to 80 pixels, with some repeated rows
+  std::vector<Sample> randoms;
+  std::mt19937        rng(1234);
+  for (int i = 0; i < 20000; i++) {
+    BitmapPtr bitmap = BitmapPtr(new Bitmap);
+    int       width  = 1 + (rng() % 80);
+    int       height = 1 + (rng() % 40);
+    bitmap->dim      = Dim(width, height);
+    int density      = rng() % 8;
+    for (int row = 0; row < height; row++) {
+      if ((row > 0) && ((rng() % 3) == 0)) {
+        bitmap->pixels.insert(bitmap->pixels.end(), bitmap->pixels.end() - width,
+                              bitmap->pixels.end());
+        continue;
+      }
+      for (int col = 0; col < width; col++) {
+        bitmap->pixels.push_back(((int)(rng() % 8) < density) ? 0xFF : 0);
+      }
+    }
+    randoms.push_back(encode(bitmap));
+  }
+
+  // The decoder must give back the encoded bitmaps
+  int mismatches = 0;
+  int rawCount   = 0;
+  for (auto *samples : {&glyphs, &randoms}) {
+    for (auto &sample : *samples) {
+      if (sample.rleMetrics.dynF == 14) rawCount++;
+      if (!roundTrip(sample, Pos(0, 0), Dim(0, 0)) ||
+          !roundTrip(sample, Pos(3, 2), Dim(5, 1)) || !spansRoundTrip(sample) ||
+          !blitRoundTrip(sample, 0, 0) || !blitRoundTrip(sample, 13, 7) ||
+          !blitRoundTrip(sample, -5, -3) || !blitRoundTrip(sample, 75, 40)) {
+        mismatches++;
+      }
+    }
+  }
+
+  std::cout << glyphs.size() << " glyphs, " << randoms.size() << " random bitmaps ("
+            << rawCount << " not compressed), " << iterations << " iterations, " << mismatches
+            << " mismatches" << std::endl;
+
+  // Decoding in a bitmap cleared beforehand, as in IBMFFontMod::load(). The same
+  // bitmap is used for all glyphs, for the decoder to be measured, not the cache
+  // misses.
+  auto run = [&](const char *name, std::vector<Sample> &samples) {
+    Bitmap bitmap;
+    bitmap.pixels = Pixels(255 * 255, 0);
+
+    auto     start = std::chrono::steady_clock::now();
+    uint64_t sum   = 0;
+    for (int i = 0; i < iterations; i++) {
+      for (auto &sample : samples) {
+        bitmap.dim = sample.bitmap->dim;
+        memset(bitmap.pixels.data(), 0, bitmap.dim.width * bitmap.dim.height);
+        RLEExtractor rle;
+        rle.retrieveBitmap(sample.rle, bitmap, Pos(0, 0), sample.rleMetrics);
+        sum += bitmap.pixels[(bitmap.dim.width * bitmap.dim.height) >> 1];
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double count = (double)samples.size() * iterations;
+    std::cout << name << ": " << elapsed.count() << " s, " << (elapsed.count() * 1e9 / count)
+              << " ns/glyph, " << (count / elapsed.count()) << " glyphs/s (" << sum << ")"
+              << std::endl;
+  };
+
+  // Painting the glyphs on a 1872 x 1404 one bit per pixel page, line by line,
+  // through a temporary bitmap (as before the spans decoder) or directly
+  auto runPage = [&](const char *name, bool direct) {
+    const uint32_t width   = 1872;
+    const uint32_t height  = 1404;
+    const uint32_t rowSize = (width + 7) >> 3;
+    Pixels         frameBuffer(rowSize * height, 0);
+    Bitmap         bitmap;
+    bitmap.pixels = Pixels(255 * 255, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      int x = 0;
+      int y = 0;
+      for (auto &sample : glyphs) {
+        const Dim &dim = sample.bitmap->dim;
+        if ((x + dim.width) > width) {
+          x = 0;
+          y = (y + 20) % (height - 20);
+        }
+        RLEExtractor rle;
+        if (direct) {
+          rle.blitOneBit(sample.rle, sample.rleMetrics, frameBuffer.data(), width, height, x, y);
+        } else {
+          bitmap.dim = dim;
+          memset(bitmap.pixels.data(), 0, dim.width * dim.height);
+          rle.retrieveBitmap(sample.rle, bitmap, Pos(0, 0), sample.rleMetrics);
+          for (int row = 0; row < dim.height; row++) {
+            MemoryPtr line = frameBuffer.data() + ((y + row) * rowSize);
+            for (int col = 0; col < dim.width; col++) {
+              if (bitmap.pixels[(row * dim.width) + col]) {
+                line[(x + col) >> 3] |= 0x80 >> ((x + col) & 7);
+              }
+            }
+          }
+        }
+        x += dim.width;
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double count = (double)glyphs.size() * iterations;
+    std::cout << name << ": " << elapsed.count() << " s, " << (elapsed.count() * 1e9 / count)
+              << " ns/glyph, " << (count / elapsed.count()) << " glyphs/s" << std::endl;
+  };
+
+  run("Unifont glyphs", glyphs);
+  run("Random bitmaps", randoms);
+  runPage("Page through bitmaps ", false);
+  runPage("Page through blitter ", true);
+
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// RLE bitmap encoding micro-benchmark.
+//
+// Compares the bit-packed rows encoder (RLEGenerator::encodeBitmap() and
+// encodeRows()) with the pixel by pixel encoder (RLEGenerator::encodePixels()),
+// on every glyph of a GNU Unifont hex file. The results of the encoders are also
+// compared, on the glyphs and on random bitmaps, to insure they are identical.
+// The number of memory allocations per glyph is also reported: encoding with a
+// reused generator in a presized pool, as done by IBMFFontMod::save(), must not
+// allocate.
+//
+// Build (from the project root):
+//
+//   g++ -O3 -std=gnu++17 -Isrc -o rleEncodeBench bench/RLEEncodeBench.cpp \
+//       src/IBMF/*.cpp src/Misc/*.cpp src/Misc/miniz.c -pthread
+//
+// Usage: rleEncodeBench <HEX Font Path> [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "IBMF/IBMFHexImport.hpp"
+#include "Misc/MappedFile.hpp"
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+  allocations++;
+  if (void *ptr = malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+struct Sample {
+  BitmapPtr                bitmap;
+  RLEGenerator::PackedRows rows;
+};
+
+static auto sameResult(RLEGenerator &a, RLEGenerator &b) -> bool {
+  return (a.getDynF() == b.getDynF()) && (a.getFirstIsBlack() == b.getFirstIsBlack()) &&
+         (*a.getData() == *b.getData());
+}
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <HEX Font Path> [iterations]" << std::endl;
+    return -1;
+  }
+  int iterations = (argc > 2) ? atoi(argv[2]) : 10;
+
+  MappedFile hexFile;
+  if (!hexFile.open(argv[1])) return -2;
+
+  IBMFHexImport      hexImport;
+  std::vector<Sample> glyphs;
+
+  for (const char *ptr = hexFile.begin(); ptr < hexFile.end();) {
+    const char *lineEnd = (const char *)memchr(ptr, '\n', hexFile.end() - ptr);
+    if (lineEnd == nullptr) lineEnd = hexFile.end();
+    const char *colon = (const char *)memchr(ptr, ':', lineEnd - ptr);
+
+    IBMFHexImport::HexGlyph hexGlyph;
+    int8_t                  hOffset, vOffset;
+    uint16_t                advance;
+    Sample                  glyph{BitmapPtr(new Bitmap)};
+
+    if (colon != nullptr) {
+      hexGlyph.codePoint = (char32_t)strtoul(ptr, nullptr, 16);
+      if (IBMFHexImport::readGlyphRows(colon + 1, lineEnd, hexGlyph) &&
+          hexImport.readOneGlyph(hexGlyph, glyph.bitmap, hOffset, vOffset, advance) &&
+          (glyph.bitmap->dim.width > 0)) {
+        RLEGenerator::packRows(glyph.bitmap, glyph.rows);
+        glyphs.push_back(glyph);
+      }
+    }
+    ptr = lineEnd + 1;
+  }
+
+  // Random bitmaps of all widths up to 80 pixels, with some repeated rows
+  std::vector<BitmapPtr> randoms;
+  std::mt19937           rng(1234);
+  for (int i = 0; i < 20000; i++) {
+    BitmapPtr bitmap = BitmapPtr(new Bitmap);
+    int       width  = 1 + (rng() % 80);
+    int       height = 1 + (rng() % 40);
+    bitmap->dim      = Dim(width, height);
+    int density      = rng() % 8;
+    for (int row = 0; row < height; row++) {
+      if ((row > 0) && ((rng() % 3) == 0)) {
+        bitmap->pixels.insert(bitmap->pixels.end(), bitmap->pixels.end() - width,
+                              bitmap->pixels.end());
+        continue;
+      }
+      for (int col = 0; col < width; col++) {
+        bitmap->pixels.push_back(((int)(rng() % 8) < density) ? 0xFF : 0);
+      }
+    }
+    randoms.push_back(bitmap);
+  }
+
+  // All encoders must give the same result
+  int          mismatches = 0;
+  RLEGenerator a, b, c;
+  for (auto &glyph : glyphs) {
+    a.clean();
+    b.clean();
+    c.clean();
+    a.encodePixels(glyph.bitmap);
+    b.encodeBitmap(glyph.bitmap);
+    c.encodeRows(glyph.rows, glyph.bitmap->dim);
+    if (!sameResult(a, b) || !sameResult(a, c)) mismatches++;
+  }
+  for (auto &bitmap : randoms) {
+    a.clean();
+    b.clean();
+    a.encodePixels(bitmap);
+    b.encodeBitmap(bitmap);
+    if (!sameResult(a, b)) mismatches++;
+  }
+
+  // A new generator for each glyph
+  auto run = [&](const char *name, auto encode) -> double {
+    uint64_t allocs = allocations;
+    auto     start  = std::chrono::steady_clock::now();
+    uint64_t sum    = 0;
+    for (int i = 0; i < iterations; i++) {
+      for (auto &glyph : glyphs) {
+        RLEGenerator gen;
+        encode(gen, glyph);
+        sum += gen.getData()->size();
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double nsPerGlyph = elapsed.count() * 1e9 / ((double)glyphs.size() * iterations);
+    double allocsPerGlyph = (double)(allocations - allocs) / ((double)glyphs.size() * iterations);
+    std::cout << name << ": " << elapsed.count() << " s, " << nsPerGlyph << " ns/glyph, "
+              << allocsPerGlyph << " allocs/glyph (" << sum << ")" << std::endl;
+    return nsPerGlyph;
+  };
+
+  // A single generator and a presized pool, as in IBMFFontMod::save()
+  auto runInPool = [&](const char *name) -> double {
+    size_t capacity = 0;
+    Dim    maxDim;
+    for (auto &glyph : glyphs) {
+      capacity += RLEGenerator::maxEncodedSize(glyph.bitmap->dim);
+      maxDim.width  = std::max(maxDim.width, glyph.bitmap->dim.width);
+      maxDim.height = std::max(maxDim.height, glyph.bitmap->dim.height);
+    }
+    RLEGenerator       gen;
+    RLEGenerator::Data pool;
+    gen.reserve(maxDim);
+    pool.reserve(capacity);
+
+    uint64_t allocs = allocations;
+    auto     start  = std::chrono::steady_clock::now();
+    uint64_t sum    = 0;
+    for (int i = 0; i < iterations; i++) {
+      pool.clear();
+      for (auto &glyph : glyphs) {
+        gen.encodeBitmap(glyph.bitmap, pool);
+      }
+      sum += pool.size();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double nsPerGlyph = elapsed.count() * 1e9 / ((double)glyphs.size() * iterations);
+    double allocsPerGlyph = (double)(allocations - allocs) / ((double)glyphs.size() * iterations);
+    std::cout << name << ": " << elapsed.count() << " s, " << nsPerGlyph << " ns/glyph, "
+              << allocsPerGlyph << " allocs/glyph (" << sum << ")" << std::endl;
+    return nsPerGlyph;
+  };
+
+  std::cout << glyphs.size() << " glyphs, " << randoms.size() << " random bitmaps, "
+            << iterations << " iterations, " << mismatches << " mismatches" << std::endl;
+
+  double t1 = run("Pixels encoder        ", [](RLEGenerator &gen, Sample &glyph) {
+    gen.encodePixels(glyph.bitmap);
+  });
+  double t2 = run("Packed (from pixels)  ", [](RLEGenerator &gen, Sample &glyph) {
+    gen.encodeBitmap(glyph.bitmap);
+  });
+  double t3 = run("Packed (from rows)    ", [](RLEGenerator &gen, Sample &glyph) {
+    gen.encodeRows(glyph.rows, glyph.bitmap->dim);
+  });
+  double t4 = runInPool("Packed (in pool)      ");
+
+  std::cout << "Speedup: " << (t1 / t2) << "x (from pixels), " << (t1 / t3) << "x (from rows), "
+            << (t1 / t4) << "x (in pool)" << std::endl;
+
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "IBMFDefs.hpp"
+
+using namespace ibmf_defs;
+
+// Least recently used cache of decoded bitmaps, bounded by the total size of
+// their pixels. The bitmaps are shared: one evicted from the cache stays valid
+// for as long as it is in use elsewhere.
+
+class BitmapCache {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+private:
+    typedef std::pair<uint32_t, BitmapPtr> Entry;
+
+    std::list<Entry> entries_; // Most recently used first
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> index_;
+    size_t budget_;
+    size_t size_{0};
+    uint64_t hits_{0};
+    uint64_t misses_{0};
+
+    void evict() {
+        while ((size_ > budget_) && !entries_.empty()) {
+            size_ -= entries_.back().second->pixels.size();
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+public:
+    BitmapCache(size_t budget = DEFAULT_BUDGET) : budget_(budget) {}
+
+    inline auto getBudget() const -> size_t { return budget_; }
+    inline auto getSize() const -> size_t { return size_; }
+    inline auto getHits() const -> uint64_t { return hits_; }
+    inline auto getMisses() const -> uint64_t { return misses_; }
+
+    void setBudget(size_t budget) {
+        budget_ = budget;
+        evict();
+    }
+
+    // Returns the bitmap cached under key, nullptr if absent
+    auto find(uint32_t key) -> BitmapPtr {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return nullptr;
+        }
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+    }
+
+    // A bitmap larger than the budget is not retained
+    void insert(uint32_t key, BitmapPtr bitmap) {
+        if (bitmap->pixels.size() > budget_) return;
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            size_ -= it->second->second->pixels.size();
+            entries_.erase(it->second);
+        }
+        entries_.emplace_front(key, bitmap);
+        index_[key] = entries_.begin();
+        size_ += bitmap->pixels.size();
+        evict();
+    }
+
+    void clear() {
+        entries_.clear();
+        index_.clear();
+        size_ = 0;
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "IBMFDefs.hpp"
+#include "RLEGenerator.hpp"
+
+using namespace ibmf_defs;
+
+// Experimental per glyph bitmap codec selection (see IBMFFontMod::setCodecOptions()).
+//
+// The available codecs are:
+//
+// - PK run length encoding (dynF 0..13), the IBMF default;
+// - Raw bitmap (dynF 14), already chosen by the RLEGenerator when smaller than
+//   its compressed form, but it may also be retained for small glyphs as it is
+//   the fastest to decode;
+// - Row-XOR delta (dynF 15): every row is XORed with the previous one before
+//   being PK encoded. The encoded data starts with a byte giving the dynF
+//   (lower 4 bits) and firstIsBlack (bit 4) of the PK encoding. This codec is
+//   not supported by the IBMF readers (other than RLEExtractor::retrieveBitmap())
+//   and must be explicitly allowed.
+
+enum class CodecPolicy : uint8_t {
+  PK_RLE,     // PK encoding, raw bitmap when smaller (the IBMF default)
+  MIN_SIZE,   // Smallest encoding of the allowed codecs
+  MIN_DECODE, // Lowest expected decoding cost of the allowed codecs
+  RAW         // Raw bitmaps only
+};
+
+// Relative decoding costs used by the MIN_DECODE policy. The default values
+// come from bench/CodecReport.cpp measurements on a x86-64 host. They are to be
+// adjusted to the device class targeted.
+struct DecodeCosts {
+  float perNybble   = 1.9f; // PK packed data
+  float perRawByte  = 1.0f; // Raw bitmap data
+  float perXorPixel = 0.15f; // Row-XOR delta reconstruction
+};
+
+struct CodecOptions {
+  CodecPolicy policy   = CodecPolicy::PK_RLE;
+  bool        xorDelta = false; // Allows the row-XOR delta codec
+  DecodeCosts costs;
+};
+
+class BitmapEncoder {
+public:
+  static constexpr uint8_t XOR_DELTA_DYN_F = 15;
+
+private:
+  CodecOptions       options;
+  RLEGenerator       gen;
+  RLEGenerator::Data pkData, rawData, xorData;
+  uint8_t            pkDynF, xorDynF;
+  bool               pkFirstIsBlack, xorFirstIsBlack;
+
+  RLEGenerator::PackedRows rows, xorRows;
+
+  uint8_t dynF;
+  bool    firstIsBlack;
+
+public:
+  BitmapEncoder(const CodecOptions &codecOptions) : options(codecOptions) {}
+
+  BitmapEncoder(const BitmapEncoder &)                     = delete;
+  auto operator=(const BitmapEncoder &) -> BitmapEncoder & = delete;
+
+  // Reserves the workspace for bitmaps up to maxDim, such that no memory allocation
+  // occurs when encoding them in a presized pool.
+  void reserve(Dim maxDim) {
+    gen.reserve(maxDim);
+    if (options.policy != CodecPolicy::PK_RLE) {
+      size_t size = RLEGenerator::maxEncodedSize(maxDim) + 1;
+      pkData.reserve(size);
+      rawData.reserve(size);
+      xorData.reserve(size);
+      rows.reserve(maxDim.height);
+      xorRows.reserve(maxDim.height);
+    }
+  }
+
+  uint8_t getDynF() { return dynF; }
+  bool    getFirstIsBlack() { return firstIsBlack; }
+
+  // Encodes the bitmap with the codec selected by the policy, the encoded bytes
+  // being appended to the pool. A pool presized with RLEGenerator::maxEncodedSize()
+  // + 1 is sufficient.
+  bool encodeBitmap(const BitmapPtr bitmap, RLEGenerator::Data &pool) {
+
+    // The IBMF default, or a bitmap too wide for the bit-packed rows
+
+    if ((options.policy == CodecPolicy::PK_RLE) ||
+        (bitmap->dim.width > RLEGenerator::MAX_PACKED_WIDTH)) {
+      if (!gen.encodeBitmap(bitmap, pool)) return false;
+      dynF         = gen.getDynF();
+      firstIsBlack = gen.getFirstIsBlack();
+      return true;
+    }
+
+    const Dim &dim = bitmap->dim;
+    RLEGenerator::packRows(bitmap, rows);
+
+    if (options.policy == CodecPolicy::RAW) {
+      if (!gen.encodeRawRows(rows, dim, pool)) return false;
+      dynF         = 14;
+      firstIsBlack = false;
+      return true;
+    }
+
+    // Candidates
+
+    pkData.clear();
+    rawData.clear();
+    xorData.clear();
+
+    if (!gen.encodeRows(rows, dim, pkData)) return false;
+    pkDynF         = gen.getDynF();
+    pkFirstIsBlack = gen.getFirstIsBlack();
+
+    if (!gen.encodeRawRows(rows, dim, rawData)) return false;
+
+    bool xorCandidate = false;
+    if (options.xorDelta && (dim.height > 1)) {
+      xorRows.resize(rows.size());
+      xorRows[0] = rows[0];
+      for (size_t row = 1; row < rows.size(); row++) {
+        xorRows[row] = rows[row] ^ rows[row - 1];
+      }
+      xorData.push_back(0); // PK metrics, set below
+      if (!gen.encodeRows(xorRows, dim, xorData)) return false;
+      xorDynF         = gen.getDynF();
+      xorFirstIsBlack = gen.getFirstIsBlack();
+      xorData[0]      = xorDynF | (xorFirstIsBlack ? 0x10 : 0);
+      xorCandidate    = xorDynF != 14;
+    }
+
+    // Selection
+
+    const DecodeCosts &costs   = options.costs;
+    float              pkCost  = (pkDynF == 14) ? (costs.perRawByte * pkData.size())
+                                                : (costs.perNybble * 2 * pkData.size());
+    float              rawCost = costs.perRawByte * rawData.size();
+    float              xorCost = (costs.perNybble * 2 * (xorData.size() - 1)) +
+                    (costs.perXorPixel * dim.width * dim.height);
+
+    enum { PK, RAW, XOR } choice = PK;
+    if (options.policy == CodecPolicy::MIN_SIZE) {
+      if (rawData.size() < pkData.size()) choice = RAW;
+      if (xorCandidate &&
+          (xorData.size() < ((choice == RAW) ? rawData.size() : pkData.size()))) {
+        choice = XOR;
+      }
+    } else { // MIN_DECODE, ties going to the smallest
+      auto better = [](float cost, size_t size, float bestCost, size_t bestSize) {
+        return (cost < bestCost) || ((cost == bestCost) && (size < bestSize));
+      };
+      if (better(rawCost, rawData.size(), pkCost, pkData.size())) choice = RAW;
+      if (xorCandidate) {
+        float  bestCost = (choice == RAW) ? rawCost : pkCost;
+        size_t bestSize = (choice == RAW) ? rawData.size() : pkData.size();
+        if (better(xorCost, xorData.size(), bestCost, bestSize)) choice = XOR;
+      }
+    }
+
+    const RLEGenerator::Data *data;
+    switch (choice) {
+      case PK:
+        data         = &pkData;
+        dynF         = pkDynF;
+        firstIsBlack = pkFirstIsBlack;
+        break;
+      case RAW:
+        data         = &rawData;
+        dynF         = 14;
+        firstIsBlack = false;
+        break;
+      default:
+        data         = &xorData;
+        dynF         = XOR_DELTA_DYN_F;
+        firstIsBlack = false;
+        break;
+    }
+    pool.insert(pool.end(), data->begin(), data->end());
+
+    return true;
+  }
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "IBMFDefs.hpp"
+
+using namespace ibmf_defs;
+
+// Variable length data of all the glyphs of a face (bitmaps' pixels, lig/kern
+// steps), kept in a single vector, each glyph having a range in it. This
+// avoids one allocation per glyph and keeps the data of consecutive glyphs
+// close in memory.
+//
+// Data replaced with a larger one is appended at the end, the previous range
+// being left unused up to the next compact().
+
+template <typename T> class GlyphArena {
+private:
+    struct Range {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    std::vector<Range> ranges_; // One for each glyph
+    std::vector<T> data_;
+    size_t unused_{0};
+
+    // Sets the range of the glyph to a new place at the end of the data
+    auto appendRange(Range &range, const T *data, size_t count) -> void {
+        if ((data != nullptr) && (data >= data_.data()) && (data < (data_.data() + data_.size()))) {
+            std::vector<T> copy(data, data + count); // From the arena itself
+            appendRange(range, copy.data(), count);
+            return;
+        }
+        range.first = data_.size();
+        range.count = count;
+        if (data == nullptr) {
+            data_.resize(data_.size() + count, T{});
+        } else {
+            data_.insert(data_.end(), data, data + count);
+        }
+    }
+
+public:
+    inline auto size() const -> size_t { return ranges_.size(); }
+    inline auto count(GlyphCode glyphCode) const -> uint32_t { return ranges_[glyphCode].count; }
+    inline auto data(GlyphCode glyphCode) -> T * { return data_.data() + ranges_[glyphCode].first; }
+    inline auto data(GlyphCode glyphCode) const -> const T * {
+        return data_.data() + ranges_[glyphCode].first;
+    }
+    inline auto begin(GlyphCode glyphCode) const -> const T * { return data(glyphCode); }
+    inline auto end(GlyphCode glyphCode) const -> const T * {
+        return data(glyphCode) + count(glyphCode);
+    }
+
+    void reserve(size_t glyphCount, size_t dataSize) {
+        ranges_.reserve(glyphCount);
+        data_.reserve(dataSize);
+    }
+
+    void clear() {
+        ranges_.clear();
+        data_.clear();
+        unused_ = 0;
+    }
+
+    // Adds a glyph at the end. With a null data pointer, its count elements are
+    // value-initialized.
+    void append(const T *data, size_t count) {
+        Range range;
+        appendRange(range, data, count);
+        ranges_.push_back(range);
+    }
+
+    // Inserts a glyph at glyphCode, the following glyphs being shifted
+    void insert(GlyphCode glyphCode, const T *data, size_t count) {
+        Range range;
+        appendRange(range, data, count);
+        ranges_.insert(ranges_.begin() + glyphCode, range);
+    }
+
+    // Replaces the glyph's data, in place when it fits. With a null data pointer,
+    // its count elements are value-initialized.
+    void set(GlyphCode glyphCode, const T *data, size_t count) {
+        Range &range = ranges_[glyphCode];
+        if (count <= range.count) {
+            if (data == nullptr) {
+                std::fill_n(data_.begin() + range.first, count, T{});
+            } else {
+                std::copy_n(data, count, data_.begin() + range.first);
+            }
+            unused_ += range.count - count;
+            range.count = count;
+        } else {
+            unused_ += range.count;
+            appendRange(range, data, count);
+        }
+    }
+
+    // True if the glyph's data is the same as the one of the other arena's glyph
+    auto same(GlyphCode glyphCode, const GlyphArena<T> &other, GlyphCode otherGlyphCode) const
+        -> bool {
+        return std::equal(begin(glyphCode), end(glyphCode), other.begin(otherGlyphCode),
+                          other.end(otherGlyphCode));
+    }
+
+    auto same(GlyphCode glyphCode, const std::vector<T> &other) const -> bool {
+        return std::equal(begin(glyphCode), end(glyphCode), other.begin(), other.end());
+    }
+
+    // Packs the data of the glyphs in glyph order, releasing the unused ranges
+    void compact() {
+        if (unused_ == 0) return;
+        std::vector<T> data;
+        data.reserve(data_.size() - unused_);
+        for (auto &range : ranges_) {
+            uint32_t first = data.size();
+            data.insert(data.end(), data_.begin() + range.first,
+                        data_.begin() + range.first + range.count);
+            range.first = first;
+        }
+        data_.swap(data);
+        unused_ = 0;
+    }
+};
+
+// Decoded bitmaps of all the glyphs of a face: their dimensions and their
+// pixels, kept in a GlyphArena.
+
+class BitmapArena {
+private:
+    std::vector<Dim> dims_;
+    GlyphArena<uint8_t> pixels_;
+
+public:
+    inline auto size() const -> size_t { return dims_.size(); }
+    inline auto dim(GlyphCode glyphCode) const -> const Dim & { return dims_[glyphCode]; }
+    inline auto pixels(GlyphCode glyphCode) const -> const uint8_t * {
+        return pixels_.data(glyphCode);
+    }
+    inline auto pixelCount(GlyphCode glyphCode) const -> uint32_t {
+        return pixels_.count(glyphCode);
+    }
+
+    void reserve(size_t glyphCount, size_t pixelCount) {
+        dims_.reserve(glyphCount);
+        pixels_.reserve(glyphCount, pixelCount);
+    }
+
+    void clear() {
+        dims_.clear();
+        pixels_.clear();
+    }
+
+    // A new Bitmap, copy of the glyph's one
+    auto get(GlyphCode glyphCode) const -> BitmapPtr {
+        BitmapPtr bitmap = BitmapPtr(new Bitmap);
+        bitmap->dim = dims_[glyphCode];
+        bitmap->pixels.assign(pixels_.begin(glyphCode), pixels_.end(glyphCode));
+        return bitmap;
+    }
+
+    void append(const Bitmap &bitmap) {
+        dims_.push_back(bitmap.dim);
+        pixels_.append(bitmap.pixels.data(), bitmap.pixels.size());
+    }
+
+    // Adds a glyph without pixels (e.g. still RLE encoded)
+    void append(Dim dim) {
+        dims_.push_back(dim);
+        pixels_.append(nullptr, 0);
+    }
+
+    void insert(GlyphCode glyphCode, const Bitmap &bitmap) {
+        dims_.insert(dims_.begin() + glyphCode, bitmap.dim);
+        pixels_.insert(glyphCode, bitmap.pixels.data(), bitmap.pixels.size());
+    }
+
+    void set(GlyphCode glyphCode, const Bitmap &bitmap) {
+        dims_[glyphCode] = bitmap.dim;
+        pixels_.set(glyphCode, bitmap.pixels.data(), bitmap.pixels.size());
+    }
+
+    // Gives the glyph width x height cleared pixels, to be decoded in place
+    auto allocate(GlyphCode glyphCode) -> MemoryPtr {
+        pixels_.set(glyphCode, nullptr, dims_[glyphCode].width * dims_[glyphCode].height);
+        return pixels_.data(glyphCode);
+    }
+
+    auto same(GlyphCode glyphCode, const BitmapArena &other, GlyphCode otherGlyphCode) const
+        -> bool {
+        return (dims_[glyphCode] == other.dims_[otherGlyphCode]) &&
+               pixels_.same(glyphCode, other.pixels_, otherGlyphCode);
+    }
+
+    auto same(GlyphCode glyphCode, const Bitmap &bitmap) const -> bool {
+        return (dims_[glyphCode] == bitmap.dim) && pixels_.same(glyphCode, bitmap.pixels);
+    }
+
+    void compact() { pixels_.compact(); }
+};
@@ -0,0 +1,116 @@
+#include "GlyphPack.hpp"
+
+#include <cstring>
+#include <fstream>
+
+auto GlyphPack::open(const std::string &filename) -> bool {
+  close();
+
+  if (!file_.open(filename)) return false;
+
+  if (file_.size() < sizeof(Header)) {
+    log_e("File too small to be a glyph pack: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  const Header *header = reinterpret_cast<const Header *>(file_.data());
+  if (strncmp("UGP1", header->marker, 4) != 0) {
+    log_e("Not a glyph pack: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  if (((header->recordsOffset + ((uint64_t)header->recordCount * sizeof(Record))) >
+       header->poolOffset) ||
+      (header->poolOffset > file_.size())) {
+    log_e("Truncated glyph pack: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    uint32_t offset = header->planeIndexOffsets[i];
+    if (offset == 0) continue;
+    if ((offset + (PLANE_SIZE * sizeof(uint32_t))) > header->recordsOffset) {
+      log_e("Truncated glyph pack: %s", filename.c_str());
+      close();
+      return false;
+    }
+    planeIndexes_[i] = reinterpret_cast<const uint32_t *>(file_.data() + offset);
+  }
+
+  records_ = reinterpret_cast<const Record *>(file_.data() + header->recordsOffset);
+  pool_    = file_.data() + header->poolOffset;
+  header_  = header;
+
+  return true;
+}
+
+void GlyphPack::close() {
+  file_.close();
+  header_  = nullptr;
+  records_ = nullptr;
+  pool_    = nullptr;
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    planeIndexes_[i] = nullptr;
+  }
+}
+
+auto GlyphPack::addRecord(char32_t codePoint, const GlyphInfo &info, const uint8_t *rle) -> bool {
+  uint32_t planeIdx = codePoint >> 16;
+  if (planeIdx >= PLANES_COUNT) return false;
+
+  if (buildIndexes_[planeIdx].empty()) {
+    buildIndexes_[planeIdx].resize(PLANE_SIZE, NO_RECORD);
+  }
+
+  uint32_t &entry = buildIndexes_[planeIdx][codePoint & 0xFFFF];
+  if (entry != NO_RECORD) return false;
+
+  entry = buildRecords_.size();
+  buildRecords_.push_back(Record{.info = info, .poolIndex = (uint32_t)buildPool_.size()});
+  buildPool_.insert(buildPool_.end(), rle, rle + info.packetLength);
+
+  return true;
+}
+
+auto GlyphPack::save(const std::string &filename) -> bool {
+  std::fstream out;
+  out.open(filename, std::ios::out | std::ios::binary);
+
+  if (!out.is_open()) {
+    log_e("Unable to create glyph pack: %s", filename.c_str());
+    return false;
+  }
+
+  Header header;
+  memcpy(header.marker, "UGP1", 4);
+  header.recordCount = buildRecords_.size();
+
+  uint32_t offset    = sizeof(Header);
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    if (buildIndexes_[i].empty()) {
+      header.planeIndexOffsets[i] = 0;
+    } else {
+      header.planeIndexOffsets[i] = offset;
+      offset += PLANE_SIZE * sizeof(uint32_t);
+    }
+  }
+  header.recordsOffset = offset;
+  header.poolOffset    = offset + (buildRecords_.size() * sizeof(Record));
+
+  out.write((char *)&header, sizeof(Header));
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    if (!buildIndexes_[i].empty()) {
+      out.write((char *)buildIndexes_[i].data(), PLANE_SIZE * sizeof(uint32_t));
+    }
+  }
+  out.write((char *)buildRecords_.data(), buildRecords_.size() * sizeof(Record));
+  out.write((char *)buildPool_.data(), buildPool_.size());
+
+  bool result = out.good();
+  out.close();
+
+  return result;
+}
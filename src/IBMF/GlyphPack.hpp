@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "../Misc/MappedFile.hpp"
+#include "IBMFDefs.hpp"
+
+using namespace ibmf_defs;
+
+// clang-format off
+//
+// Pre-encoded glyph pack. Built once from a GNU Unifont hex file (see
+// IBMFHexImport::compilePack()), it contains, for each codePoint, the final
+// GlyphInfo metrics and the RLE encoded bitmap as they will appear in an IBMF
+// font. Generating a font from a pack is then a matter of selecting and
+// concatenating records (see IBMFHexImport::loadPack()).
+//
+//  At Offset 0:
+//  +--------------------+
+//  |                    |  Header (32 bytes)
+//  +--------------------+
+//  |                    |  For each plane present (planeIndexOffsets[plane] != 0):
+//  |                    |  65536 32 bits entries giving the record index of each
+//  |                    |  codePoint of the plane (NO_RECORD if absent).
+//  +--------------------+
+//  |                    |  Records (GlyphInfo + index in the pool)
+//  +--------------------+
+//  |                    |  Pool of RLE encoded bitmaps
+//  +--------------------+
+//
+// clang-format on
+
+class GlyphPack {
+public:
+#pragma pack(push, 1)
+  struct Header {
+    char     marker[4]; // "UGP1"
+    uint32_t recordCount;
+    uint32_t planeIndexOffsets[4];
+    uint32_t recordsOffset;
+    uint32_t poolOffset;
+  };
+
+  struct Record {
+    GlyphInfo info;      // ligKernPgmIndex and mainCode are set at generation time
+    uint32_t  poolIndex; // Location of the RLE bitmap in the pool (info.packetLength bytes)
+  };
+#pragma pack(pop)
+
+  static constexpr uint32_t NO_RECORD    = 0xFFFFFFFF;
+  static constexpr int      PLANE_SIZE   = 65536;
+  static constexpr int      PLANES_COUNT = 4;
+
+private:
+  MappedFile      file_;
+  const Header   *header_{nullptr};
+  const uint32_t *planeIndexes_[PLANES_COUNT]{nullptr, nullptr, nullptr, nullptr};
+  const Record   *records_{nullptr};
+  const uint8_t  *pool_{nullptr};
+
+  // Used only when building a pack
+  std::vector<uint32_t> buildIndexes_[PLANES_COUNT];
+  std::vector<Record>   buildRecords_;
+  std::vector<uint8_t>  buildPool_;
+
+public:
+  GlyphPack() = default;
+
+  auto open(const std::string &filename) -> bool;
+  void close();
+  inline auto isOpen() const -> bool { return header_ != nullptr; }
+
+  // Retrieves the record of a codePoint and its RLE bitmap. Returns false if absent.
+  inline auto getRecord(char32_t codePoint, const Record *&record, const uint8_t *&rle) const
+      -> bool {
+    uint32_t planeIdx = codePoint >> 16;
+    if ((planeIdx >= PLANES_COUNT) || (planeIndexes_[planeIdx] == nullptr)) return false;
+    uint32_t idx = planeIndexes_[planeIdx][codePoint & 0xFFFF];
+    if (idx == NO_RECORD) return false;
+    record = &records_[idx];
+    rle    = pool_ + record->poolIndex;
+    return true;
+  }
+
+  // Pack construction
+  auto addRecord(char32_t codePoint, const GlyphInfo &info, const uint8_t *rle) -> bool;
+  auto save(const std::string &filename) -> bool;
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <cinttypes>
+#include <iterator>
 #include <memory>
 #include <vector>
 
@@ -216,6 +218,19 @@ struct RLEBitmap {
 };
 typedef std::shared_ptr<RLEBitmap> RLEBitmapPtr;
 
+// Non-owning access to RLE encoded data, as located in a font's memory image.
+// The RLEExtractor decodes from it, a RLEBitmap being converted implicitly.
+
+struct RLEBitmapView {
+    const uint8_t *data;
+    uint16_t length;
+    Dim dim;
+    RLEBitmapView(const uint8_t *theData, uint16_t theLength, Dim theDim)
+        : data(theData), length(theLength), dim(theDim) {}
+    RLEBitmapView(const RLEBitmap &bitmap)
+        : data(bitmap.pixels.data()), length(bitmap.length), dim(bitmap.dim) {}
+};
+
 // Uncompressed Bitmap.
 
 struct Bitmap {
@@ -604,11 +619,13 @@ typedef std::shared_ptr<FontParameters> FontParametersPtr;
 // Of course, the three letters must be present in the resulting font to have
 // that ligature added to the font.
 
-const struct Ligature {
+struct Ligature {
     char32_t firstChar;
     char32_t nextChar;
     char32_t replacement;
-} ligatures[] = {
+};
+
+constexpr Ligature ligatures[] = {
     {0x0066, 0x0066, 0xFB00}, // f, f, ﬀ
     {0x0066, 0x0069, 0xFB01}, // f, i, ﬁ
     {0x0066, 0x006C, 0xFB02}, // f, l, ﬂ
@@ -627,6 +644,23 @@ const struct Ligature {
     {0x002D, 0x002D, 0x2013}, // -, -, –
 };
 
+// The ligature table sorted by firstChar at compile time, the ligatures of a
+// same first character staying in table order. Lets the ligatures of a font be
+// retrieved from its first characters only.
+constexpr auto sortLigaturesByFirstChar() -> std::array<Ligature, std::size(ligatures)> {
+    std::array<Ligature, std::size(ligatures)> sorted{};
+    for (size_t i = 0; i < sorted.size(); i++) {
+        size_t j = i;
+        for (; (j > 0) && (sorted[j - 1].firstChar > ligatures[i].firstChar); j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = ligatures[i];
+    }
+    return sorted;
+}
+
+constexpr auto ligaturesByFirstChar = sortLigaturesByFirstChar();
+
 const constexpr char32_t ZERO_WIDTH_CODEPOINT = 0xFEFF; // U+0FEFF
 const constexpr char32_t UNKNOWN_CODEPOINT = 0xE05E;    // U+E05E This is part of the Sol Font.
 
@@ -3,30 +3,36 @@
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+#include "../Misc/Parallel.hpp"
+#include "../Misc/log.hpp"
 
 void IBMFFontMod::clear() {
     initialized_ = false;
     for (auto &face : faces_) {
-        for (auto bitmap : face->bitmaps) {
-            bitmap->clear();
-        }
-        for (auto bitmap : face->compressedBitmaps) {
-            bitmap->clear();
-        }
         face->glyphs.clear();
         face->backupGlyphs.clear();
         face->bitmaps.clear();
         face->compressedBitmaps.clear();
-        face->glyphsLigKern.clear();
+        face->ligSteps.clear();
+        face->kernSteps.clear();
+        face->backupLigSteps.clear();
+        face->backupKernSteps.clear();
         face->ligKernSteps.clear();
+        face->ligKernIndex.clear();
     }
     faces_.clear();
     faceOffsets_.clear();
+    preEncoded_ = false;
+    bitmapCache_.clear();
     planes_.clear();
     codePointBundles_.clear();
+    bundleGlyphCodes_.clear();
 }
 
-bool IBMFFontMod::load() {
+bool IBMFFontMod::load(bool lazy) {
     // Preamble retrieval
     memcpy(&preamble_, memory_, sizeof(Preamble));
     if (strncmp("IBMF", preamble_.marker, 4) != 0) return false;
@@ -57,9 +63,12 @@ bool IBMFFontMod::load() {
         }
         idx += (((*planes)[3].codePointBundlesIdx + (*planes)[3].entriesCount) *
                 sizeof(CodePointBundle));
+
+        buildGlyphCodeIndex();
     } else {
         planes_.clear();
         codePointBundles_.clear();
+        bundleGlyphCodes_.clear();
     }
 
     // Faces retrieval
@@ -79,126 +88,87 @@ bool IBMFFontMod::load() {
         glyphsPixelPoolIndexes = reinterpret_cast<GlyphsPixelPoolIndexesTempPtr>(&memory_[idx]);
         idx += (sizeof(PixelPoolIndex) * header->glyphCount);
 
-        // Glyphs info and bitmaps
-
-        if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
-            pixelsPool = reinterpret_cast<PixelsPoolTempPtr>(
-                &memory_[idx + (sizeof(BackupGlyphInfo) * header->glyphCount)]);
-
-            face->backupGlyphs.reserve(header->glyphCount);
-
-            for (int glyphCode = 0; glyphCode < header->glyphCount; glyphCode++) {
-                BackupGlyphInfoPtr backupGlyphInfo = BackupGlyphInfoPtr(new BackupGlyphInfo);
-                memcpy(backupGlyphInfo.get(), &memory_[idx], sizeof(BackupGlyphInfo));
-                idx += sizeof(BackupGlyphInfo);
-
-                int bitmap_size = backupGlyphInfo->bitmapHeight * backupGlyphInfo->bitmapWidth;
-                BitmapPtr bitmap = BitmapPtr(new Bitmap);
-                bitmap->pixels = Pixels(bitmap_size, 0);
-                bitmap->dim = Dim(backupGlyphInfo->bitmapWidth, backupGlyphInfo->bitmapHeight);
-
-                RLEBitmapPtr compressedBitmap = RLEBitmapPtr(new RLEBitmap);
-                compressedBitmap->dim = bitmap->dim;
-                compressedBitmap->pixels.reserve(backupGlyphInfo->packetLength);
-                compressedBitmap->length = backupGlyphInfo->packetLength;
-                for (int pos = 0; pos < backupGlyphInfo->packetLength; pos++) {
-                    compressedBitmap->pixels.push_back(
-                        (*pixelsPool)[pos + (*glyphsPixelPoolIndexes)[glyphCode]]);
-                }
+        // Glyphs info and bitmaps. The bitmaps are decoded in the face's bitmap
+        // arena, unless loaded lazily: their RLE encoded data is then kept as is.
 
-                RLEExtractor rle;
-                rle.retrieveBitmap(*compressedBitmap, *bitmap, Pos(0, 0),
-                                   backupGlyphInfo->rleMetrics);
-                // retrieveBitmap(idx, glyphInfo.get(), *bitmap, Pos(0,0));
+        bool keepEncoded = lazy && (preamble_.bits.fontFormat != FontFormat::BACKUP);
 
-                face->backupGlyphs.push_back(backupGlyphInfo);
-                face->bitmaps.push_back(bitmap);
-                face->compressedBitmaps.push_back(compressedBitmap);
+        auto loadGlyphs = [&](auto &glyphs) {
+            glyphs.resize(header->glyphCount);
+            memcpy(glyphs.data(), &memory_[idx], sizeof(glyphs[0]) * header->glyphCount);
+            idx += sizeof(glyphs[0]) * header->glyphCount;
+            pixelsPool = reinterpret_cast<PixelsPoolTempPtr>(&memory_[idx]);
 
-                // idx += glyphInfo->packetLength;
+            size_t pixelCount = 0;
+            size_t rleSize = 0;
+            for (auto &glyph : glyphs) {
+                pixelCount += glyph.bitmapWidth * glyph.bitmapHeight;
+                rleSize += glyph.packetLength;
             }
-        } else {
-            pixelsPool = reinterpret_cast<PixelsPoolTempPtr>(
-                &memory_[idx + (sizeof(GlyphInfo) * header->glyphCount)]);
-
-            face->glyphs.reserve(header->glyphCount);
+            face->bitmaps.reserve(header->glyphCount, keepEncoded ? 0 : pixelCount);
+            if (keepEncoded) face->compressedBitmaps.reserve(header->glyphCount, rleSize);
 
             for (int glyphCode = 0; glyphCode < header->glyphCount; glyphCode++) {
-                GlyphInfoPtr glyphInfo = GlyphInfoPtr(new GlyphInfo);
-                memcpy(glyphInfo.get(), &memory_[idx], sizeof(GlyphInfo));
-                idx += sizeof(GlyphInfo);
-
-                int bitmap_size = glyphInfo->bitmapHeight * glyphInfo->bitmapWidth;
-                BitmapPtr bitmap = BitmapPtr(new Bitmap);
-                bitmap->pixels = Pixels(bitmap_size, 0);
-                bitmap->dim = Dim(glyphInfo->bitmapWidth, glyphInfo->bitmapHeight);
-
-                RLEBitmapPtr compressedBitmap = RLEBitmapPtr(new RLEBitmap);
-                compressedBitmap->dim = bitmap->dim;
-                compressedBitmap->pixels.reserve(glyphInfo->packetLength);
-                compressedBitmap->length = glyphInfo->packetLength;
-                for (int pos = 0; pos < glyphInfo->packetLength; pos++) {
-                    compressedBitmap->pixels.push_back(
-                        (*pixelsPool)[pos + (*glyphsPixelPoolIndexes)[glyphCode]]);
+                auto &glyph = glyphs[glyphCode];
+                Dim dim = Dim(glyph.bitmapWidth, glyph.bitmapHeight);
+                RLEBitmapView compressedBitmap(
+                    &(*pixelsPool)[(*glyphsPixelPoolIndexes)[glyphCode]], glyph.packetLength, dim);
+
+                face->bitmaps.append(dim);
+                if (keepEncoded) {
+                    face->compressedBitmaps.append(compressedBitmap.data, compressedBitmap.length);
+                } else {
+                    MemoryPtr pixels = face->bitmaps.allocate(glyphCode);
+                    if (glyph.packetLength > 0) {
+                        RLEExtractor rle;
+                        rle.retrieveBitmap(compressedBitmap, pixels, dim, Pos(0, 0),
+                                           glyph.rleMetrics);
+                    }
                 }
-
-                RLEExtractor rle;
-                rle.retrieveBitmap(*compressedBitmap, *bitmap, Pos(0, 0), glyphInfo->rleMetrics);
-                // retrieveBitmap(idx, glyphInfo.get(), *bitmap, Pos(0,0));
-
-                face->glyphs.push_back(glyphInfo);
-                face->bitmaps.push_back(bitmap);
-                face->compressedBitmaps.push_back(compressedBitmap);
-
-                // idx += glyphInfo->packetLength;
             }
-        }
+        };
 
-        if (&memory_[idx] != (uint8_t *)pixelsPool) {
-            return false;
+        if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
+            loadGlyphs(face->backupGlyphs);
+        } else {
+            loadGlyphs(face->glyphs);
         }
 
         idx += header->pixelsPoolSize;
 
         if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
             for (GlyphCode glyphCode = 0; glyphCode < header->glyphCount; glyphCode++) {
-                BackupGlyphLigKernPtr glk = BackupGlyphLigKernPtr(new BackupGlyphLigKern);
-
-                for (int i = 0; i < face->backupGlyphs[glyphCode]->ligCount; i++) {
-                    BackupGlyphLigStep l;
-                    memcpy(&l, &memory_[idx], sizeof(BackupGlyphLigStep));
-                    idx += sizeof(BackupGlyphLigStep);
-                    glk->ligSteps.push_back(l);
-                }
-                for (int i = 0; i < face->backupGlyphs[glyphCode]->kernCount; i++) {
-                    BackupGlyphKernStep k;
-                    memcpy(&k, &memory_[idx], sizeof(BackupGlyphKernStep));
-                    idx += sizeof(BackupGlyphKernStep);
-                    glk->kernSteps.push_back(k);
-                }
-                face->backupGlyphsLigKern.push_back(glk);
+                const BackupGlyphInfo &glyph = face->backupGlyphs[glyphCode];
+
+                face->backupLigSteps.append(
+                    reinterpret_cast<const BackupGlyphLigStep *>(&memory_[idx]), glyph.ligCount);
+                idx += sizeof(BackupGlyphLigStep) * glyph.ligCount;
+                face->backupKernSteps.append(
+                    reinterpret_cast<const BackupGlyphKernStep *>(&memory_[idx]), glyph.kernCount);
+                idx += sizeof(BackupGlyphKernStep) * glyph.kernCount;
             }
 
             face->header = header;
             faces_.push_back(std::move(face));
         } else {
             if (header->ligKernStepCount > 0) {
-                face->ligKernSteps.reserve(header->ligKernStepCount);
-                for (int j = 0; j < header->ligKernStepCount; j++) {
-                    LigKernStep step;
-                    memcpy(&step, &memory_[idx], sizeof(LigKernStep));
-
-                    face->ligKernSteps.push_back(step);
-
-                    idx += sizeof(LigKernStep);
-                }
+                face->ligKernSteps.resize(header->ligKernStepCount);
+                memcpy(face->ligKernSteps.data(), &memory_[idx],
+                       sizeof(LigKernStep) * header->ligKernStepCount);
+                idx += sizeof(LigKernStep) * header->ligKernStepCount;
             }
 
+            face->ligSteps.reserve(header->glyphCount, 0);
+            face->kernSteps.reserve(header->glyphCount, 0);
+
+            GlyphLigSteps ligSteps;
+            GlyphKernSteps kernSteps;
             for (GlyphCode glyphCode = 0; glyphCode < header->glyphCount; glyphCode++) {
-                GlyphLigKernPtr glk = GlyphLigKernPtr(new GlyphLigKern);
+                ligSteps.clear();
+                kernSteps.clear();
 
-                if (face->glyphs[glyphCode]->ligKernPgmIndex != 255) {
-                    int lk_idx = face->glyphs[glyphCode]->ligKernPgmIndex;
+                if (face->glyphs[glyphCode].ligKernPgmIndex != 255) {
+                    int lk_idx = face->glyphs[glyphCode].ligKernPgmIndex;
                     if (lk_idx < header->ligKernStepCount) {
                         if ((face->ligKernSteps[lk_idx].b.goTo.isAGoTo) &&
                             (face->ligKernSteps[lk_idx].b.kern.isAKern)) {
@@ -207,12 +177,12 @@ bool IBMFFontMod::load() {
                         do {
                             if (face->ligKernSteps[lk_idx]
                                     .b.kern.isAKern) { // true = kern, false = ligature
-                                glk->kernSteps.push_back(GlyphKernStep{
+                                kernSteps.push_back(GlyphKernStep{
                                     .nextGlyphCode =
                                         face->ligKernSteps[lk_idx].a.data.nextGlyphCode,
                                     .kern = face->ligKernSteps[lk_idx].b.kern.kerningValue});
                             } else {
-                                glk->ligSteps.push_back(GlyphLigStep{
+                                ligSteps.push_back(GlyphLigStep{
                                     .nextGlyphCode =
                                         face->ligKernSteps[lk_idx].a.data.nextGlyphCode,
                                     .replacementGlyphCode =
@@ -221,7 +191,8 @@ bool IBMFFontMod::load() {
                         } while (!face->ligKernSteps[lk_idx++].a.data.stop);
                     }
                 }
-                face->glyphsLigKern.push_back(glk);
+                face->ligSteps.append(ligSteps.data(), ligSteps.size());
+                face->kernSteps.append(kernSteps.data(), kernSteps.size());
             }
 
             face->header = header;
@@ -229,9 +200,69 @@ bool IBMFFontMod::load() {
         }
     }
 
+    preEncoded_ = lazy && (preamble_.bits.fontFormat != FontFormat::BACKUP);
+
     return true;
 }
 
+// Decodes the pre-encoded RLE bitmaps (see preEncoded_)
+auto IBMFFontMod::ensureBitmaps() const -> void {
+    if (!preEncoded_) return;
+
+    for (auto &face : faces_) {
+        size_t pixelCount = 0;
+        for (int glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
+            const Dim &dim = face->bitmaps.dim(glyphCode);
+            pixelCount += dim.width * dim.height;
+        }
+        face->bitmaps.reserve(face->header->glyphCount, pixelCount);
+        for (int glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
+            decodeBitmap(face, glyphCode, face->bitmaps.allocate(glyphCode));
+        }
+        face->compressedBitmaps.clear();
+    }
+    preEncoded_ = false;
+    bitmapCache_.clear();
+}
+
+// Decodes the glyph's pre-encoded RLE bitmap in pixels, cleared and sized
+// for the glyph's dimensions
+auto IBMFFontMod::decodeBitmap(const FacePtr &face, GlyphCode glyphCode, MemoryPtr pixels) const
+    -> void {
+    uint32_t length = face->compressedBitmaps.count(glyphCode);
+    if (length > 0) {
+        const Dim &dim = face->bitmaps.dim(glyphCode);
+        RLEExtractor rle;
+        rle.retrieveBitmap(RLEBitmapView(face->compressedBitmaps.data(glyphCode), length, dim),
+                           pixels, dim, Pos(0, 0), face->glyphs[glyphCode].rleMetrics);
+    }
+}
+
+// The glyph's bitmap, for read-only use. When pre-encoded, the bitmap is
+// decoded on demand and retained in the bitmap cache.
+auto IBMFFontMod::glyphBitmap(int faceIdx, GlyphCode glyphCode) const -> BitmapPtr {
+    const FacePtr &face = faces_[faceIdx];
+    if (!preEncoded_) return face->bitmaps.get(glyphCode);
+
+    uint32_t key = (faceIdx << 16) | glyphCode;
+    BitmapPtr bitmap;
+    {
+        std::lock_guard<std::mutex> lock(bitmapCacheMutex_);
+        bitmap = bitmapCache_.find(key);
+    }
+    if (bitmap == nullptr) {
+        const Dim &dim = face->bitmaps.dim(glyphCode);
+        bitmap = BitmapPtr(new Bitmap);
+        bitmap->dim = dim;
+        bitmap->pixels = Pixels(dim.width * dim.height, 0);
+        decodeBitmap(face, glyphCode, bitmap->pixels.data());
+
+        std::lock_guard<std::mutex> lock(bitmapCacheMutex_);
+        bitmapCache_.insert(key, bitmap);
+    }
+    return bitmap;
+}
+
 #define WRITE(v, size) out.write((char *)v, size)
 
 #define WRITE2(v, size) out.write((char *)v, size)
@@ -285,129 +316,193 @@ auto IBMFFontMod::save(std::ostream &out) -> bool {
             return false;
         }
 
-        int idx = 0;
         int glyphCount = 0;
-        std::vector<uint8_t> *poolData = new std::vector<uint8_t>();
-        std::vector<uint32_t> *poolIndexes = new std::vector<uint32_t>();
 
-        if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
-            for (auto &glyph : face->backupGlyphs) {
-                if (face->bitmaps[idx]->dim.width == 0) {
-                    glyph->rleMetrics.dynF = 14;
-                    glyph->rleMetrics.firstIsBlack = false;
-                    glyph->packetLength = 0;
-                    poolIndexes->push_back(0);
-                    idx += 1;
-                } else {
-                    RLEGenerator *gen = new RLEGenerator;
-                    if (!gen->encodeBitmap(face->bitmaps[idx++])) {
-                        poolData->clear();
-                        delete poolData;
-                        poolIndexes->clear();
-                        delete poolIndexes;
-
-                        lastError_ = 3;
-                        return false;
+        // The glyphs are encoded in parallel, by chunks of consecutive glyphs. Each
+        // chunk is encoded in its own buffer, presized for the worst case
+        // (uncompressed bitmaps), the encoder workspace being reused from one
+        // glyph to the next. The pool indexes are first relative to the chunk
+        // buffer; the buffers are then concatenated in glyph order, such that the
+        // result does not depend on the number of threads.
+        static constexpr size_t ENCODE_CHUNK_SIZE = 512;
+
+        RLEGenerator::Data poolData;
+        std::vector<uint32_t> poolIndexes(face->bitmaps.size(), 0);
+
+        face->bitmaps.compact();
+
+        auto encodeGlyphs = [&](auto &glyphs) -> bool {
+            size_t chunkCount = (glyphs.size() + ENCODE_CHUNK_SIZE - 1) / ENCODE_CHUNK_SIZE;
+            std::vector<RLEGenerator::Data> chunkData(chunkCount);
+            std::vector<char> chunkFailed(chunkCount, false);
+
+            parallelFor(chunkCount, threadCountFor(threadCount_), [&](size_t chunk) {
+                size_t first = chunk * ENCODE_CHUNK_SIZE;
+                size_t last = std::min(first + ENCODE_CHUNK_SIZE, glyphs.size());
+
+                size_t capacity = 0;
+                Dim maxDim = Dim(0, 0);
+                for (size_t idx = first; idx < last; idx++) {
+                    const Dim &dim = face->bitmaps.dim(idx);
+                    capacity += RLEGenerator::maxEncodedSize(dim);
+                    maxDim.width = std::max(maxDim.width, dim.width);
+                    maxDim.height = std::max(maxDim.height, dim.height);
+                }
+
+                BitmapEncoder encoder(codecOptions_);
+                RLEGenerator::Data &data = chunkData[chunk];
+                BitmapPtr bitmap = BitmapPtr(new Bitmap);
+                encoder.reserve(maxDim);
+                data.reserve(capacity);
+                bitmap->pixels.reserve(maxDim.width * maxDim.height);
+
+                for (size_t idx = first; idx < last; idx++) {
+                    auto &glyph = glyphs[idx];
+                    bitmap->dim = face->bitmaps.dim(idx);
+                    if (bitmap->dim.width == 0) {
+                        glyph.rleMetrics.dynF = 14;
+                        glyph.rleMetrics.firstIsBlack = false;
+                        glyph.packetLength = 0;
+                    } else {
+                        size_t start = data.size();
+                        bitmap->pixels.assign(face->bitmaps.pixels(idx),
+                                              face->bitmaps.pixels(idx) +
+                                                  face->bitmaps.pixelCount(idx));
+                        if (!encoder.encodeBitmap(bitmap, data)) {
+                            chunkFailed[chunk] = true;
+                            return;
+                        }
+                        glyph.rleMetrics.dynF = encoder.getDynF();
+                        glyph.rleMetrics.firstIsBlack = encoder.getFirstIsBlack();
+                        glyph.packetLength = data.size() - start;
+                        poolIndexes[idx] = start;
                     }
-                    glyph->rleMetrics.dynF = gen->getDynF();
-                    glyph->rleMetrics.firstIsBlack = gen->getFirstIsBlack();
-                    auto data = gen->getData();
-                    glyph->packetLength = data->size();
-                    poolIndexes->push_back(poolData->size());
-                    copy(data->begin(), data->end(), std::back_inserter(*poolData));
-                    delete gen;
                 }
+            });
+
+            size_t poolSize = 0;
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                if (chunkFailed[chunk]) return false;
+                poolSize += chunkData[chunk].size();
+            }
+            poolData.reserve(poolSize);
+
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                uint32_t base = poolData.size();
+                size_t first = chunk * ENCODE_CHUNK_SIZE;
+                size_t last = std::min(first + ENCODE_CHUNK_SIZE, glyphs.size());
+                for (size_t idx = first; idx < last; idx++) {
+                    if (face->bitmaps.dim(idx).width != 0) poolIndexes[idx] += base;
+                }
+                poolData.insert(poolData.end(), chunkData[chunk].begin(), chunkData[chunk].end());
             }
-        } else {
+            return true;
+        };
+
+        if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
+            if (!encodeGlyphs(face->backupGlyphs)) {
+                lastError_ = 3;
+                return false;
+            }
+        } else if (preEncoded_) {
+            int idx = 0;
             for (auto &glyph : face->glyphs) {
-                if (face->bitmaps[idx]->dim.width == 0) {
-                    glyph->rleMetrics.dynF = 14;
-                    glyph->rleMetrics.firstIsBlack = false;
-                    glyph->packetLength = 0;
-                    poolIndexes->push_back(0);
-                    idx += 1;
-                } else {
-                    RLEGenerator *gen = new RLEGenerator;
-                    if (!gen->encodeBitmap(face->bitmaps[idx++])) {
-                        poolData->clear();
-                        delete poolData;
-                        poolIndexes->clear();
-                        delete poolIndexes;
-
-                        lastError_ = 3;
-                        return false;
+                if (glyph.bitmapWidth != 0) {
+                    poolIndexes[idx] = poolData.size();
+                    poolData.insert(poolData.end(), face->compressedBitmaps.begin(idx),
+                                    face->compressedBitmaps.begin(idx) + glyph.packetLength);
+                }
+                idx += 1;
+            }
+        } else {
+            if (!encodeGlyphs(face->glyphs)) {
+                lastError_ = 3;
+                return false;
+            }
+        }
+
+        // Identical bitmaps (e.g. vertical forms and their originals, duplicate
+        // punctuation) are kept once in the pool, the duplicates pointing at the
+        // first copy.
+        auto dedupPool = [&](auto &glyphs) {
+            RLEGenerator::Data dedupData;
+            std::unordered_map<std::string_view, uint32_t> firstCopies;
+            dedupData.reserve(poolData.size());
+            firstCopies.reserve(glyphs.size());
+
+            int duplicates = 0;
+            int idx = 0;
+            for (auto &glyph : glyphs) {
+                if (glyph.packetLength > 0) {
+                    std::string_view rle(
+                        reinterpret_cast<const char *>(poolData.data() + poolIndexes[idx]),
+                        glyph.packetLength);
+                    auto [firstCopy, inserted] = firstCopies.try_emplace(rle, dedupData.size());
+                    if (inserted) {
+                        dedupData.insert(dedupData.end(), rle.begin(), rle.end());
+                    } else {
+                        duplicates++;
                     }
-                    glyph->rleMetrics.dynF = gen->getDynF();
-                    glyph->rleMetrics.firstIsBlack = gen->getFirstIsBlack();
-                    auto data = gen->getData();
-                    glyph->packetLength = data->size();
-                    poolIndexes->push_back(poolData->size());
-                    copy(data->begin(), data->end(), std::back_inserter(*poolData));
-                    delete gen;
+                    poolIndexes[idx] = firstCopy->second;
                 }
+                idx++;
             }
+
+            log_i("Pixels pool: %d duplicate bitmaps, %u bytes saved (%u bytes left).", duplicates,
+                  (unsigned)(poolData.size() - dedupData.size()), (unsigned)dedupData.size());
+            poolData.swap(dedupData);
+        };
+
+        if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
+            dedupPool(face->backupGlyphs);
+        } else {
+            dedupPool(face->glyphs);
         }
 
-        fill = 4 - (poolData->size() + (sizeof(GlyphInfo) * face->header->glyphCount) &
+        fill = 4 - (poolData.size() + (sizeof(GlyphInfo) * face->header->glyphCount) &
                     3); // to keep alignment to 32bits offsets
         if (fill == 4) fill = 0;
 
-        face->header->pixelsPoolSize = poolData->size() + fill;
+        face->header->pixelsPoolSize = poolData.size() + fill;
         face->header->ligKernStepCount =
             (preamble_.bits.fontFormat == FontFormat::BACKUP) ? 0 : face->ligKernSteps.size();
 
         WRITE2(face->header.get(), sizeof(FaceHeader));
 
-        for (auto idx : *poolIndexes) {
-            WRITE2(&idx, sizeof(uint32_t));
-        }
+        WRITE2(poolIndexes.data(), poolIndexes.size() * sizeof(uint32_t));
 
         if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
             int idx = 0;
             for (auto &glyph : face->backupGlyphs) {
-                glyph->ligCount = face->backupGlyphsLigKern[idx]->ligSteps.size();
-                glyph->kernCount = face->backupGlyphsLigKern[idx]->kernSteps.size();
-                WRITE2(glyph.get(), sizeof(BackupGlyphInfo));
+                glyph.ligCount = face->backupLigSteps.count(idx);
+                glyph.kernCount = face->backupKernSteps.count(idx);
+                WRITE2(&glyph, sizeof(BackupGlyphInfo));
                 glyphCount++;
                 idx++;
             }
         } else {
             for (auto &glyph : face->glyphs) {
-                WRITE2(glyph.get(), sizeof(GlyphInfo));
+                WRITE2(&glyph, sizeof(GlyphInfo));
                 glyphCount++;
             }
         }
 
         if (glyphCount != face->header->glyphCount) {
             lastError_ = 5;
-            poolIndexes->clear();
-            poolData->clear();
-            delete poolData;
-            delete poolIndexes;
             return false;
         }
 
-        WRITE2(poolData->data(), poolData->size());
+        WRITE2(poolData.data(), poolData.size());
         while (fill--) {
             WRITE2(&filler, 1);
         }
 
-        poolIndexes->clear();
-        poolData->clear();
-        delete poolData;
-        delete poolIndexes;
-
         if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
-            int idx = 0;
-            for (auto &glyph : face->backupGlyphs) {
-                BackupGlyphLigKernPtr glk = face->backupGlyphsLigKern[idx];
-                for (int i = 0; i < glyph->ligCount; i++) {
-                    WRITE(&glk->ligSteps[i], sizeof(BackupGlyphLigStep));
-                }
-                for (int i = 0; i < glyph->kernCount; i++) {
-                    WRITE(&glk->kernSteps[i], sizeof(BackupGlyphKernStep));
-                }
-                idx += 1;
+            for (GlyphCode idx = 0; idx < face->backupGlyphs.size(); idx++) {
+                WRITE(face->backupLigSteps.data(idx),
+                      sizeof(BackupGlyphLigStep) * face->backupLigSteps.count(idx));
+                WRITE(face->backupKernSteps.data(idx),
+                      sizeof(BackupGlyphKernStep) * face->backupKernSteps.count(idx));
             }
         } else {
             int ligKernCount = 0;
@@ -445,7 +540,7 @@ auto IBMFFontMod::findGlyphIndex(FacePtr face, char32_t codePoint) -> int {
 
     int idx = 0;
     for (auto &glyph : face->backupGlyphs) {
-        if (glyph->codePoint == codePoint) return idx;
+        if (glyph.codePoint == codePoint) return idx;
         idx++;
     }
     return -1;
@@ -455,6 +550,8 @@ auto IBMFFontMod::saveGlyph(int faceIndex, int glyphCode, GlyphInfoPtr newGlyphI
                             BitmapPtr newBitmap, GlyphLigKernPtr glyphLigKern, IBMFFontModPtr font)
     -> bool {
 
+    ensureBitmaps();
+
     if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
         if ((font == nullptr) || !font->isInitialized() || !isInitialized()) {
             return false;
@@ -475,63 +572,47 @@ auto IBMFFontMod::saveGlyph(int faceIndex, int glyphCode, GlyphInfoPtr newGlyphI
             preamble_.faceCount += 1;
         }
 
-        BackupGlyphInfoPtr backupGlyphInfo = BackupGlyphInfoPtr(
-            new BackupGlyphInfo{.bitmapWidth = newGlyphInfo->bitmapWidth,
-                                .bitmapHeight = newGlyphInfo->bitmapHeight,
-                                .horizontalOffset = newGlyphInfo->horizontalOffset,
-                                .verticalOffset = newGlyphInfo->verticalOffset,
-                                .packetLength = newGlyphInfo->packetLength,
-                                .advance = newGlyphInfo->advance,
-                                .rleMetrics = newGlyphInfo->rleMetrics,
-                                .ligCount = 0,
-                                .kernCount = 0,
-                                .mainCodePoint = font->getUTF32(newGlyphInfo->mainCode),
-                                .codePoint = font->getUTF32(glyphCode)});
-
-        int idx = findGlyphIndex(face, backupGlyphInfo->codePoint);
+        BackupGlyphInfo backupGlyphInfo{.bitmapWidth = newGlyphInfo->bitmapWidth,
+                                        .bitmapHeight = newGlyphInfo->bitmapHeight,
+                                        .horizontalOffset = newGlyphInfo->horizontalOffset,
+                                        .verticalOffset = newGlyphInfo->verticalOffset,
+                                        .packetLength = newGlyphInfo->packetLength,
+                                        .advance = newGlyphInfo->advance,
+                                        .rleMetrics = newGlyphInfo->rleMetrics,
+                                        .ligCount = 0,
+                                        .kernCount = 0,
+                                        .mainCodePoint = font->getUTF32(newGlyphInfo->mainCode),
+                                        .codePoint = font->getUTF32(glyphCode)};
+
+        BackupGlyphLigKern glk;
+        for (auto &l : glyphLigKern->ligSteps) {
+            BackupGlyphLigStep ls;
+            ls.nextCodePoint = font->getUTF32(l.nextGlyphCode);
+            ls.replacementCodePoint = font->getUTF32(l.replacementGlyphCode);
+            glk.ligSteps.push_back(ls);
+        }
+        for (auto &k : glyphLigKern->kernSteps) {
+            BackupGlyphKernStep ks;
+            ks.nextCodePoint = font->getUTF32(k.nextGlyphCode);
+            ks.kern = k.kern;
+            glk.kernSteps.push_back(ks);
+        }
 
-        if (idx != -1) {
-            face->backupGlyphsLigKern[idx]->ligSteps.clear();
-            face->backupGlyphsLigKern[idx]->kernSteps.clear();
-            for (auto &l : glyphLigKern->ligSteps) {
-                BackupGlyphLigStep ls;
-                ls.nextCodePoint = font->getUTF32(l.nextGlyphCode);
-                ls.replacementCodePoint = font->getUTF32(l.replacementGlyphCode);
-                face->backupGlyphsLigKern[idx]->ligSteps.push_back(ls);
-            }
-            for (auto &k : glyphLigKern->kernSteps) {
-                BackupGlyphKernStep ks;
-                ks.nextCodePoint = font->getUTF32(k.nextGlyphCode);
-                ks.kern = k.kern;
-                face->backupGlyphsLigKern[idx]->kernSteps.push_back(ks);
-            }
+        backupGlyphInfo.ligCount = glk.ligSteps.size();
+        backupGlyphInfo.kernCount = glk.kernSteps.size();
 
-            backupGlyphInfo->ligCount = face->backupGlyphsLigKern[idx]->ligSteps.size();
-            backupGlyphInfo->kernCount = face->backupGlyphsLigKern[idx]->kernSteps.size();
+        int idx = findGlyphIndex(face, backupGlyphInfo.codePoint);
 
+        if (idx != -1) {
             face->backupGlyphs[idx] = backupGlyphInfo;
-            face->bitmaps[idx] = newBitmap;
+            face->bitmaps.set(idx, *newBitmap);
+            face->backupLigSteps.set(idx, glk.ligSteps.data(), glk.ligSteps.size());
+            face->backupKernSteps.set(idx, glk.kernSteps.data(), glk.kernSteps.size());
         } else {
-            BackupGlyphLigKernPtr glk = BackupGlyphLigKernPtr(new BackupGlyphLigKern);
-            for (auto &l : glyphLigKern->ligSteps) {
-                BackupGlyphLigStep ls;
-                ls.nextCodePoint = font->getUTF32(l.nextGlyphCode);
-                ls.replacementCodePoint = font->getUTF32(l.replacementGlyphCode);
-                glk->ligSteps.push_back(ls);
-            }
-            for (auto &k : glyphLigKern->kernSteps) {
-                BackupGlyphKernStep ks;
-                ks.nextCodePoint = font->getUTF32(k.nextGlyphCode);
-                ks.kern = k.kern;
-                glk->kernSteps.push_back(ks);
-            }
-
-            backupGlyphInfo->ligCount = glk->ligSteps.size();
-            backupGlyphInfo->kernCount = glk->kernSteps.size();
-
             face->backupGlyphs.push_back(backupGlyphInfo);
-            face->bitmaps.push_back(newBitmap);
-            face->backupGlyphsLigKern.push_back(glk);
+            face->bitmaps.append(*newBitmap);
+            face->backupLigSteps.append(glk.ligSteps.data(), glk.ligSteps.size());
+            face->backupKernSteps.append(glk.kernSteps.data(), glk.kernSteps.size());
 
             face->header->glyphCount += 1;
         }
@@ -541,9 +622,9 @@ auto IBMFFontMod::saveGlyph(int faceIndex, int glyphCode, GlyphInfoPtr newGlyphI
             return false;
         }
 
-        faces_[faceIndex]->glyphs[glyphCode] = newGlyphInfo;
-        faces_[faceIndex]->bitmaps[glyphCode] = newBitmap;
-        faces_[faceIndex]->glyphsLigKern[glyphCode] = glyphLigKern;
+        faces_[faceIndex]->glyphs[glyphCode] = *newGlyphInfo;
+        faces_[faceIndex]->bitmaps.set(glyphCode, *newBitmap);
+        faces_[faceIndex]->setLigKern(glyphCode, *glyphLigKern);
     }
 
     return true;
@@ -561,6 +642,9 @@ auto IBMFFontMod::saveGlyph(int faceIndex, int glyphCode, GlyphInfoPtr newGlyphI
 /// Note: character codes have to be translated to internal GlyphCode before
 /// calling this method.
 ///
+/// Once buildLigKernIndex() has been called, the entry is retrieved through the
+/// face's LigKernIndex, unless **bypassLigKern** is given.
+///
 /// @param glyphCode1 In. The GlyhCode for which to find a LigKern entry in its program.
 /// @param glyphCode2 InOut. The GlyphCode that must appear in the program as the next
 ///                   character in sequence. Will be replaced with the target
@@ -582,38 +666,59 @@ auto IBMFFontMod::ligKern(int faceIndex, const GlyphCode glyphCode1, GlyphCode *
         return false;
     }
 
+    GlyphCode code = faces_[faceIndex]->glyphs[*glyphCode2].mainCode;
+    FIX16 k;
+
+    const LigKernIndex &index = faces_[faceIndex]->ligKernIndex;
+    if ((bypassLigKern == nullptr) && index.built()) {
+        GlyphCode replacementGlyphCode;
+        if (index.findLig(glyphCode1, *glyphCode2, replacementGlyphCode)) {
+            *glyphCode2 = replacementGlyphCode;
+            return true;
+        }
+        if (index.findKern(glyphCode1, code, k)) {
+            if (k & 0x2000) k |= 0xC000;
+            *kern = k;
+            *kernPairPresent = true;
+        }
+        return false;
+    }
+
     //
-    GlyphLigSteps *ligSteps;
-    GlyphKernSteps *kernSteps;
+    const GlyphLigStep *ligSteps, *ligStepsEnd;
+    const GlyphKernStep *kernSteps, *kernStepsEnd;
 
     if (bypassLigKern == nullptr) {
-        ligSteps = &faces_[faceIndex]->glyphsLigKern[glyphCode1]->ligSteps;
-        kernSteps = &faces_[faceIndex]->glyphsLigKern[glyphCode1]->kernSteps;
+        ligSteps = faces_[faceIndex]->ligSteps.begin(glyphCode1);
+        ligStepsEnd = faces_[faceIndex]->ligSteps.end(glyphCode1);
+        kernSteps = faces_[faceIndex]->kernSteps.begin(glyphCode1);
+        kernStepsEnd = faces_[faceIndex]->kernSteps.end(glyphCode1);
     } else {
-        ligSteps = &bypassLigKern->ligSteps;
-        kernSteps = &bypassLigKern->kernSteps;
+        ligSteps = bypassLigKern->ligSteps.data();
+        ligStepsEnd = ligSteps + bypassLigKern->ligSteps.size();
+        kernSteps = bypassLigKern->kernSteps.data();
+        kernStepsEnd = kernSteps + bypassLigKern->kernSteps.size();
     }
 
-    if ((ligSteps->size() == 0) && (kernSteps->size() == 0)) {
+    if ((ligSteps == ligStepsEnd) && (kernSteps == kernStepsEnd)) {
         return false;
     }
 
-    GlyphCode code = faces_[faceIndex]->glyphs[*glyphCode2]->mainCode;
     // if (preamble_.bits.fontFormat == FontFormat::LATIN) {
     //     code &= LATIN_GLYPH_CODE_MASK;
     // }
     bool first = true;
 
-    for (auto &ligStep : *ligSteps) {
-        if (ligStep.nextGlyphCode == *glyphCode2) {
-            *glyphCode2 = ligStep.replacementGlyphCode;
+    for (auto ligStep = ligSteps; ligStep != ligStepsEnd; ligStep++) {
+        if (ligStep->nextGlyphCode == *glyphCode2) {
+            *glyphCode2 = ligStep->replacementGlyphCode;
             return true;
         }
     }
 
-    for (auto &kernStep : *kernSteps) {
-        if (kernStep.nextGlyphCode == code) {
-            FIX16 k = kernStep.kern;
+    for (auto kernStep = kernSteps; kernStep != kernStepsEnd; kernStep++) {
+        if (kernStep->nextGlyphCode == code) {
+            k = kernStep->kern;
             if (k & 0x2000) k |= 0xC000;
             *kern = k;
             *kernPairPresent = true;
@@ -623,6 +728,12 @@ auto IBMFFontMod::ligKern(int faceIndex, const GlyphCode glyphCode1, GlyphCode *
     return false;
 }
 
+auto IBMFFontMod::buildLigKernIndex() -> void {
+    for (auto &face : faces_) {
+        face->ligKernIndex.build(face->ligSteps, face->kernSteps);
+    }
+}
+
 auto IBMFFontMod::getGlyph(int faceIndex, int glyphCode, GlyphInfoPtr &glyphInfo, BitmapPtr &bitmap,
                            GlyphLigKernPtr &glyphLigKern) const -> bool {
 
@@ -633,9 +744,39 @@ auto IBMFFontMod::getGlyph(int faceIndex, int glyphCode, GlyphInfoPtr &glyphInfo
 
     int glyphIndex = glyphCode;
 
-    glyphInfo = std::make_shared<GlyphInfo>(*faces_[faceIndex]->glyphs[glyphIndex]);
-    bitmap = std::make_shared<Bitmap>(*faces_[faceIndex]->bitmaps[glyphIndex]);
-    glyphLigKern = std::make_shared<GlyphLigKern>(*faces_[faceIndex]->glyphsLigKern[glyphCode]);
+    glyphInfo = std::make_shared<GlyphInfo>(faces_[faceIndex]->glyphs[glyphIndex]);
+    if (preEncoded_) {
+        bitmap = std::make_shared<Bitmap>(*glyphBitmap(faceIndex, glyphIndex));
+    } else {
+        bitmap = faces_[faceIndex]->bitmaps.get(glyphIndex);
+    }
+    glyphLigKern = faces_[faceIndex]->getLigKern(glyphIndex);
+
+    return true;
+}
+
+auto IBMFFontMod::getGlyphView(int faceIndex, int glyphCode, GlyphView &view) const -> bool {
+
+    if ((faceIndex >= preamble_.faceCount) || (glyphCode < 0) ||
+        (glyphCode >= faces_[faceIndex]->header->glyphCount)) {
+        return false;
+    }
+
+    const FacePtr &face = faces_[faceIndex];
+
+    view.glyphInfo = &face->glyphs[glyphCode];
+    view.dim = face->bitmaps.dim(glyphCode);
+    if (preEncoded_) {
+        view.decodedBitmap = glyphBitmap(faceIndex, glyphCode);
+        view.pixels = view.decodedBitmap->pixels.data();
+    } else {
+        view.decodedBitmap = nullptr;
+        view.pixels = face->bitmaps.pixels(glyphCode);
+    }
+    view.ligSteps = face->ligSteps.data(glyphCode);
+    view.ligCount = face->ligSteps.count(glyphCode);
+    view.kernSteps = face->kernSteps.data(glyphCode);
+    view.kernCount = face->kernSteps.count(glyphCode);
 
     return true;
 }
@@ -661,20 +802,58 @@ auto IBMFFontMod::convertToOneBit(const Bitmap &bitmapHeightBits, BitmapPtr *bit
     return pix->size() == (bitmapHeightBits.dim.height * ((bitmapHeightBits.dim.width + 7) >> 3));
 }
 
-// In the process of optimizing the size of the ligKern table, this method
-// search to find if a part of the already prepared list contains the same
-// steps as per the pgm received as a parameter. If so, the index of the
-// similar list of steps is returned, else -1
-auto IBMFFontMod::findList(std::vector<LigKernStep> &pgm, std::vector<LigKernStep> &list) const
-    -> int {
-
-    auto pred = [](const LigKernStep &e1, const LigKernStep &e2) -> bool {
+// In the process of optimizing the size of the ligKern table, a glyph's pgm
+// is searched in the already prepared list. As the last step of a pgm is the
+// only one with its stop flag set, a pgm can only be found as the suffix of a
+// pgm already in the list: all the suffixes of the list's pgms are hashed in
+// an index, giving the first location of each distinct suffix.
+class LigKernSuffixes {
+private:
+    const std::vector<LigKernStep> &list_;
+    std::unordered_multimap<uint64_t, int> firstIndexes_; // By hash
+    std::vector<uint64_t> hashes_;
+
+    static inline auto same(const LigKernStep &e1, const LigKernStep &e2) -> bool {
         return (e1.a.whole.val == e2.a.whole.val) && (e1.b.whole.val == e2.b.whole.val);
-    };
+    }
 
-    auto it = std::search(list.begin(), list.end(), pgm.begin(), pgm.end(), pred);
-    return (it == list.end()) ? -1 : std::distance(list.begin(), it);
-}
+    // Index in the list of the steps [first, first + count), -1 if absent
+    auto find(const LigKernStep *first, size_t count, uint64_t hash) const -> int {
+        auto range = firstIndexes_.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+            if (((it->second + count) <= list_.size()) &&
+                std::equal(first, first + count, list_.begin() + it->second, same)) {
+                return it->second;
+            }
+        }
+        return -1;
+    }
+
+public:
+    LigKernSuffixes(const std::vector<LigKernStep> &list) : list_(list) {}
+
+    // Index in the list of the pgm, -1 if absent. Must be called before
+    // append() for each pgm.
+    auto find(const std::vector<LigKernStep> &pgm) -> int {
+        hashes_.resize(pgm.size());
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t k = pgm.size(); k-- > 0;) { // hashes_[k]: steps k to the end
+            uint32_t step = (static_cast<uint32_t>(pgm[k].a.whole.val) << 16) | pgm[k].b.whole.val;
+            hash = (hash ^ step) * 0x100000001b3ULL;
+            hashes_[k] = hash;
+        }
+        return find(pgm.data(), pgm.size(), hashes_[0]);
+    }
+
+    // Indexes the suffixes of the pgm just added to the list at index. Once a
+    // suffix is already known, the shorter ones are known too.
+    void append(int index, size_t count) {
+        for (size_t k = 0; k < count; k++) {
+            if (find(&list_[index + k], count - k, hashes_[k]) != -1) break;
+            firstIndexes_.emplace(hashes_[k], index + k);
+        }
+    }
+};
 
 // For all faces:
 //
@@ -699,6 +878,7 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
         // < -1 if it has been relocated
         std::vector<int> glyphsPgmIndexes(face->header->glyphCount, -1);
         std::vector<LigKernStep> glyphPgm;
+        LigKernSuffixes suffixes(lkSteps);
 
         // ----- Retrieves all ligature and kerning in a single list -----
         //
@@ -712,25 +892,25 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
         int glyphIdx = 0;
         for (int glyphIdx = 0; glyphIdx < face->header->glyphCount; glyphIdx++) {
 
-            auto &lSteps = face->glyphsLigKern[glyphIdx]->ligSteps;
-            auto &kSteps = face->glyphsLigKern[glyphIdx]->kernSteps;
+            auto lStepsBegin = face->ligSteps.begin(glyphIdx);
+            auto lStepsEnd = face->ligSteps.end(glyphIdx);
+            auto kStepsBegin = face->kernSteps.begin(glyphIdx);
+            auto kStepsEnd = face->kernSteps.end(glyphIdx);
 
             glyphPgm.clear();
-            if (!(lSteps.empty() && kSteps.empty())) {
-                glyphPgm.reserve(lSteps.size() + kSteps.size());
-            }
+            glyphPgm.reserve(face->ligSteps.count(glyphIdx) + face->kernSteps.count(glyphIdx));
 
-            for (auto &lStep : lSteps) {
+            for (auto lStep = lStepsBegin; lStep != lStepsEnd; lStep++) {
                 glyphPgm.push_back(LigKernStep{
-                    .a = {.data = {.nextGlyphCode = lStep.nextGlyphCode, .stop = false}},
+                    .a = {.data = {.nextGlyphCode = lStep->nextGlyphCode, .stop = false}},
                     .b = {
-                        .repl = {.replGlyphCode = lStep.replacementGlyphCode, .isAKern = false}}});
+                        .repl = {.replGlyphCode = lStep->replacementGlyphCode, .isAKern = false}}});
             }
 
-            for (auto &kStep : kSteps) {
+            for (auto kStep = kStepsBegin; kStep != kStepsEnd; kStep++) {
                 glyphPgm.push_back(LigKernStep{
-                    .a = {.data = {.nextGlyphCode = kStep.nextGlyphCode, .stop = false}},
-                    .b = {.kern = {.kerningValue = (FIX14)kStep.kern,
+                    .a = {.data = {.nextGlyphCode = kStep->nextGlyphCode, .stop = false}},
+                    .b = {.kern = {.kerningValue = (FIX14)kStep->kern,
                                    .isAGoTo = false,
                                    .isAKern = true}}});
             }
@@ -743,7 +923,7 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
                 //           Must start at 2 as cannot have a sameIdx equal to 0 or 1:
                 //           Cannot negate 0, and -1 is reserved for a null pgm in
                 //           glyphsPgmIndexes
-                if ((sameIdx = findList(glyphPgm, lkSteps)) > 1) {
+                if ((sameIdx = suffixes.find(glyphPgm)) > 1) {
                     // We found a duplicated list. Remove the duplicate one and make it
                     // point to the first found to be similar.
                     glyphPgm.clear();
@@ -754,6 +934,7 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
                     uniquePgmIndexes.insert(index);
                     glyphsPgmIndexes[glyphIdx] = index;
                     std::move(glyphPgm.begin(), glyphPgm.end(), std::back_inserter(lkSteps));
+                    suffixes.append(index, glyphPgm.size());
                 }
             }
         }
@@ -763,7 +944,9 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
         // Put them in a vector such that we can access them through indices.
 
         // Compute how many entries we need to add to the lig/kern vector to
-        // redirect over the limiting 255 indexes, and where to add them.
+        // redirect over the limiting 255 indexes, and where to add them. As
+        // a pgm index may be a suffix of another pgm, the entries must be
+        // added at the start of a pgm, not to split the one before.
 
         int spaceRequired = 0;
         int newLigKernIdx = 0;
@@ -776,42 +959,44 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
                     overflowList.insert(*idx);
                     spaceRequired += 1;
                     newLigKernIdx = *idx;
+                    if ((*idx > 0) && !lkSteps[*idx - 1].a.data.stop) continue;
                 }
                 break;
             }
         }
 
+        // The goto entries are inserted at newLigKernIdx, for the overflowed
+        // indexes in decreasing order. The glyphs' pgm indexes are then
+        // redirected to the gotos in a single pass.
+
+        std::vector<LigKernStep> gotoSteps;
+        std::unordered_map<int, int> gotoIndexes; // Overflowed index -> goto index
         for (auto idx = overflowList.rbegin(); idx != overflowList.rend(); idx++) {
-            // std::cout << *idx << " treatment: " << std::endl;
             LigKernStep ligKernStep;
             memset(&ligKernStep, 0, sizeof(LigKernStep));
             ligKernStep.b.goTo.isAKern = true;
             ligKernStep.b.goTo.isAGoTo = true;
             ligKernStep.b.goTo.displacement = (*idx + spaceRequired);
 
-            // std::cout << "Added goto at location " << *idx << " to point at location "
-            //           << (*idx + spaceRequired) << std::endl;
-
-            lkSteps.insert(lkSteps.begin() + newLigKernIdx, ligKernStep);
-            int gCode = 0;
-            for (auto pgmIdx = glyphsPgmIndexes.begin(); pgmIdx != glyphsPgmIndexes.end();
-                 pgmIdx++) {
-                if (abs(*pgmIdx) == *idx) { // Must look at both duplicated and
-                                            // non-duplicated indexes
-                    // std::cout << "Entry " << gCode << " pointing at " << *pgmIdx << " redirected
-                    // to "
-                    //           << (-5000 - newLigKernIdx) << std::endl;
-                    *pgmIdx = -5000 - newLigKernIdx;
+            gotoIndexes[*idx] = newLigKernIdx + gotoSteps.size();
+            gotoSteps.push_back(ligKernStep);
+        }
+        lkSteps.insert(lkSteps.begin() + newLigKernIdx, gotoSteps.begin(), gotoSteps.end());
+
+        if (!gotoIndexes.empty()) {
+            for (auto &pgmIdx : glyphsPgmIndexes) {
+                // Must look at both duplicated and non-duplicated indexes
+                auto gotoIndex = gotoIndexes.find(abs(pgmIdx));
+                if (gotoIndex != gotoIndexes.end()) {
+                    pgmIdx = -5000 - gotoIndex->second;
                 }
-                gCode++;
             }
-            newLigKernIdx++;
-        } // for
+        }
 
         glyphIdx = 0;
         for (auto &glyph : face->glyphs) {
             if (glyphsPgmIndexes[glyphIdx] == -1) {
-                glyph->ligKernPgmIndex = 255;
+                glyph.ligKernPgmIndex = 255;
             } else {
                 if ((abs(glyphsPgmIndexes[glyphIdx]) >= 255) &&
                     (abs(glyphsPgmIndexes[glyphIdx]) < 5000)) {
@@ -822,9 +1007,9 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
                     return false;
                 }
                 if (abs(glyphsPgmIndexes[glyphIdx]) >= 5000) {
-                    glyph->ligKernPgmIndex = abs(glyphsPgmIndexes[glyphIdx]) - 5000;
+                    glyph.ligKernPgmIndex = abs(glyphsPgmIndexes[glyphIdx]) - 5000;
                 } else {
-                    glyph->ligKernPgmIndex = abs(glyphsPgmIndexes[glyphIdx]);
+                    glyph.ligKernPgmIndex = abs(glyphsPgmIndexes[glyphIdx]);
                 }
             }
             glyphIdx += 1;
@@ -834,34 +1019,43 @@ auto IBMFFontMod::prepareLigKernVectors() -> bool {
     return true;
 }
 
-auto IBMFFontMod::toGlyphCode(char32_t codePoint) const -> GlyphCode {
+auto IBMFFontMod::buildGlyphCodeIndex() -> void {
+    bundleGlyphCodes_.assign(codePointBundles_.size(), 0);
+    for (auto &plane : planes_) {
+        int gCode = plane.firstGlyphCode;
+        for (int i = plane.codePointBundlesIdx; i < plane.codePointBundlesIdx + plane.entriesCount;
+             i++) {
+            bundleGlyphCodes_[i] = gCode;
+            gCode += codePointBundles_[i].lastCodePoint - codePointBundles_[i].firstCodePoint + 1;
+        }
+    }
+}
 
-    GlyphCode glyphCode = NO_GLYPH_CODE;
+// Binary search of the codePoint in its plane's bundles. Returns notFound if the
+// codePoint is not part of the font.
+auto IBMFFontMod::findGlyphCode(char32_t codePoint, GlyphCode notFound) const -> GlyphCode {
 
     uint16_t planeIdx = static_cast<uint16_t>(codePoint >> 16);
 
-    if (planeIdx <= 3) {
+    if (planeIdx < planes_.size()) {
         char16_t u16 = static_cast<char16_t>(codePoint);
 
-        uint16_t codePointBundleIdx = planes_[planeIdx].codePointBundlesIdx;
-        uint16_t entriesCount = planes_[planeIdx].entriesCount;
-        int gCode = planes_[planeIdx].firstGlyphCode;
-        int i = 0;
-        while (i < entriesCount) {
-            if (u16 <= codePointBundles_[codePointBundleIdx].lastCodePoint) {
-                break;
-            }
-            gCode += (codePointBundles_[codePointBundleIdx].lastCodePoint -
-                      codePointBundles_[codePointBundleIdx].firstCodePoint + 1);
-            i++;
-            codePointBundleIdx++;
-        }
-        if ((i < entriesCount) && (u16 >= codePointBundles_[codePointBundleIdx].firstCodePoint)) {
-            glyphCode = gCode + u16 - codePointBundles_[codePointBundleIdx].firstCodePoint;
+        auto first = codePointBundles_.begin() + planes_[planeIdx].codePointBundlesIdx;
+        auto last = first + planes_[planeIdx].entriesCount;
+        auto bundle = std::partition_point(
+            first, last, [u16](const CodePointBundle &b) { return b.lastCodePoint < u16; });
+
+        if ((bundle != last) && (u16 >= bundle->firstCodePoint)) {
+            return bundleGlyphCodes_[bundle - codePointBundles_.begin()] + u16 -
+                   bundle->firstCodePoint;
         }
     }
 
-    return glyphCode;
+    return notFound;
+}
+
+auto IBMFFontMod::toGlyphCode(char32_t codePoint) const -> GlyphCode {
+    return findGlyphCode(codePoint, NO_GLYPH_CODE);
 }
 
 /**
@@ -918,34 +1112,7 @@ auto IBMFFontMod::toGlyphCode(char32_t codePoint) const -> GlyphCode {
  * @return The internal representation of CodePoint
  */
 auto IBMFFontMod::translate(char32_t codePoint) const -> GlyphCode {
-    GlyphCode glyphCode = SPACE_CODE;
-
-
-    uint16_t planeIdx = static_cast<uint16_t>(codePoint >> 16);
-
-    if (planeIdx <= 3) {
-        char16_t u16 = static_cast<char16_t>(codePoint);
-
-        uint16_t codePointBundleIdx = planes_[planeIdx].codePointBundlesIdx;
-        uint16_t entriesCount = planes_[planeIdx].entriesCount;
-        int gCode = planes_[planeIdx].firstGlyphCode;
-        int i = 0;
-        while (i < entriesCount) {
-            if (u16 <= codePointBundles_[codePointBundleIdx].lastCodePoint) {
-                break;
-            }
-            gCode += (codePointBundles_[codePointBundleIdx].lastCodePoint -
-                        codePointBundles_[codePointBundleIdx].firstCodePoint + 1);
-            i++;
-            codePointBundleIdx++;
-        }
-        if ((i < entriesCount) &&
-            (u16 >= codePointBundles_[codePointBundleIdx].firstCodePoint)) {
-            glyphCode = gCode + u16 - codePointBundles_[codePointBundleIdx].firstCodePoint;
-        }
-    }
-
-    return glyphCode;
+    return findGlyphCode(codePoint, SPACE_CODE);
 }
 
 // Returns the corresponding UTF32 character for the glyphCode.
@@ -958,24 +1125,18 @@ auto IBMFFontMod::getUTF32(GlyphCode glyphCode) const -> char32_t {
     }
     if (i < 4) {
         int planeMask = i << 16;
-        int bundleIdx = planes_[i].codePointBundlesIdx;
-        int idx = planes_[i].firstGlyphCode;
-        int entriesCount = planes_[i].entriesCount;
-        int j = 0;
-        int bundleSize = codePointBundles_[bundleIdx].lastCodePoint -
-                            codePointBundles_[bundleIdx].firstCodePoint + 1;
-
-        while (j < entriesCount) {
-            if ((idx + bundleSize) > glyphCode) break;
-            idx += bundleSize;
-            bundleIdx += 1;
-            bundleSize = codePointBundles_[bundleIdx].lastCodePoint -
-                            codePointBundles_[bundleIdx].firstCodePoint + 1;
-            j += 1;
-        }
-        if (j < entriesCount) {
-            codePoint =
-                (codePointBundles_[bundleIdx].firstCodePoint + (glyphCode - idx)) | planeMask;
+        auto first = bundleGlyphCodes_.begin() + planes_[i].codePointBundlesIdx;
+        auto last = first + planes_[i].entriesCount;
+
+        // The last bundle starting at or before glyphCode
+        auto start = std::upper_bound(first, last, glyphCode);
+        if (start != first) {
+            int bundleIdx = (start - 1) - bundleGlyphCodes_.begin();
+            int offset = glyphCode - *(start - 1);
+            if (offset <= (codePointBundles_[bundleIdx].lastCodePoint -
+                           codePointBundles_[bundleIdx].firstCodePoint)) {
+                codePoint = (codePointBundles_[bundleIdx].firstCodePoint + offset) | planeMask;
+            }
         }
     }
     return codePoint;
@@ -1020,33 +1181,33 @@ auto IBMFFontMod::showBitmap(std::ostream &stream, const BitmapPtr bitmap) const
 }
 
 auto IBMFFontMod::showBackupGlyphInfo(std::ostream &stream, GlyphCode i,
-                                      const BackupGlyphInfoPtr g) const -> void {
+                                      const BackupGlyphInfo &g) const -> void {
     stream << "  [" << i << "]: "
-           << "codePoint: " << "U+" << std::hex << std::setw(5) << std::setfill('0') << g->codePoint << std::dec
-           << ", w: " << +g->bitmapWidth << ", h: " << +g->bitmapHeight
-           << ", hoff: " << +g->horizontalOffset << ", voff: " << +g->verticalOffset
-           << ", pktLen: " << +g->packetLength << ", adv: " << +((float)g->advance / 64.0)
-           << ", dynF: " << +g->rleMetrics.dynF << ", 1stBlack: " << +g->rleMetrics.firstIsBlack
-           << ", ligCnt: " << +g->ligCount << ", kernCnt: " << +g->kernCount;
-
-    if (g->mainCodePoint != g->codePoint) {
-        stream << ", mainCodePoint: " << "U+" << std::hex << std::setw(5) << std::setfill('0') << g->mainCodePoint << std::dec;
+           << "codePoint: " << "U+" << std::hex << std::setw(5) << std::setfill('0') << g.codePoint << std::dec
+           << ", w: " << +g.bitmapWidth << ", h: " << +g.bitmapHeight
+           << ", hoff: " << +g.horizontalOffset << ", voff: " << +g.verticalOffset
+           << ", pktLen: " << +g.packetLength << ", adv: " << +((float)g.advance / 64.0)
+           << ", dynF: " << +g.rleMetrics.dynF << ", 1stBlack: " << +g.rleMetrics.firstIsBlack
+           << ", ligCnt: " << +g.ligCount << ", kernCnt: " << +g.kernCount;
+
+    if (g.mainCodePoint != g.codePoint) {
+        stream << ", mainCodePoint: " << "U+" << std::hex << std::setw(5) << std::setfill('0') << g.mainCodePoint << std::dec;
     }
     stream << std::endl;
 }
 
-auto IBMFFontMod::showGlyphInfo(std::ostream &stream, GlyphCode i, const GlyphInfoPtr g) const
+auto IBMFFontMod::showGlyphInfo(std::ostream &stream, GlyphCode i, const GlyphInfo &g) const
     -> void {
     stream << "  [" << i << "]: "
            << "codePoint: " << "U+" << std::hex << std::setw(5) << std::setfill('0') << getUTF32(i) << std::dec
-           << ", w: " << +g->bitmapWidth << ", h: " << +g->bitmapHeight
-           << ", hoff: " << +g->horizontalOffset << ", voff: " << +g->verticalOffset
-           << ", pktLen: " << +g->packetLength << ", adv: " << +((float)g->advance / 64.0)
-           << ", dynF: " << +g->rleMetrics.dynF << ", 1stBlack: " << +g->rleMetrics.firstIsBlack
-           << ", lKPgmIdx: " << +g->ligKernPgmIndex;
-
-    if (g->mainCode != i) {
-        stream << ", mainCode: " << g->mainCode;
+           << ", w: " << +g.bitmapWidth << ", h: " << +g.bitmapHeight
+           << ", hoff: " << +g.horizontalOffset << ", voff: " << +g.verticalOffset
+           << ", pktLen: " << +g.packetLength << ", adv: " << +((float)g.advance / 64.0)
+           << ", dynF: " << +g.rleMetrics.dynF << ", 1stBlack: " << +g.rleMetrics.firstIsBlack
+           << ", lKPgmIdx: " << +g.ligKernPgmIndex;
+
+    if (g.mainCode != i) {
+        stream << ", mainCode: " << g.mainCode;
     }
     stream << std::endl;
 }
@@ -1097,6 +1258,8 @@ auto IBMFFontMod::showLigKerns(std::ostream &stream, GlyphLigKernPtr lk) const -
 }
 
 auto IBMFFontMod::showFace(std::ostream &stream, FacePtr face, bool withBitmaps) const -> void {
+    int faceIdx = std::find(faces_.begin(), faces_.end(), face) - faces_.begin();
+
     stream << std::endl << "=========== Face Header: ===========" << std::endl;
 
     stream << "DPI: " << face->header->dpi << ", point siz: " << +face->header->pointSize
@@ -1115,14 +1278,14 @@ auto IBMFFontMod::showFace(std::ostream &stream, FacePtr face, bool withBitmaps)
     for (int i = 0; i < face->header->glyphCount; i++) {
         if (preamble_.bits.fontFormat == FontFormat::BACKUP) {
             showBackupGlyphInfo(stream, i, face->backupGlyphs[i]);
-            showBackupLigKerns(stream, face->backupGlyphsLigKern[i]);
+            showBackupLigKerns(stream, face->getBackupLigKern(i));
         } else {
             showGlyphInfo(stream, i, face->glyphs[i]);
-            showLigKerns(stream, face->glyphsLigKern[i]);
+            showLigKerns(stream, face->getLigKern(i));
         }
 
         if (withBitmaps) {
-            showBitmap(stream, face->bitmaps[i]);
+            showBitmap(stream, glyphBitmap(faceIdx, i));
         }
     }
 }
@@ -1175,24 +1338,35 @@ auto IBMFFontMod::showFont(std::ostream &stream, std::string fontName, bool with
 
 void IBMFFontMod::recomputeLigatures() {
     for (auto &face : faces_) {
-        // Recompute all ligatures from the pre-defined table
-
-        for (uint16_t glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
-            char32_t firstChar = getUTF32(glyphCode);
-            face->glyphsLigKern[glyphCode]->ligSteps.clear();
-            for (auto &ligature : ligatures) {
-                if (ligature.firstChar == firstChar) {
-                    GlyphCode nextGlyphCode = translate(ligature.nextChar);
-                    GlyphCode replacementGlyphCode = translate(ligature.replacement);
-                    if ((nextGlyphCode != NO_GLYPH_CODE) && (nextGlyphCode != SPACE_CODE) &&
-                        (replacementGlyphCode != NO_GLYPH_CODE) &&
-                        (replacementGlyphCode != SPACE_CODE)) {
-                        face->glyphsLigKern[glyphCode]->ligSteps.push_back(
-                            GlyphLigStep{.nextGlyphCode = nextGlyphCode,
-                                         .replacementGlyphCode = replacementGlyphCode});
-                    }
+        // Recompute all ligatures from the pre-defined table. Only the glyphs of
+        // the table's first characters can get some.
+
+        for (GlyphCode glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
+            if (face->ligSteps.count(glyphCode) > 0) face->ligSteps.set(glyphCode, nullptr, 0);
+        }
+
+        GlyphLigSteps ligSteps;
+        for (auto ligature = ligaturesByFirstChar.begin(); ligature != ligaturesByFirstChar.end();) {
+            char32_t firstChar = ligature->firstChar;
+            GlyphCode glyphCode = toGlyphCode(firstChar);
+            ligSteps.clear();
+            for (; (ligature != ligaturesByFirstChar.end()) && (ligature->firstChar == firstChar);
+                 ligature++) {
+                GlyphCode nextGlyphCode = translate(ligature->nextChar);
+                GlyphCode replacementGlyphCode = translate(ligature->replacement);
+                if ((nextGlyphCode != NO_GLYPH_CODE) && (nextGlyphCode != SPACE_CODE) &&
+                    (replacementGlyphCode != NO_GLYPH_CODE) &&
+                    (replacementGlyphCode != SPACE_CODE)) {
+                    ligSteps.push_back(GlyphLigStep{.nextGlyphCode = nextGlyphCode,
+                                                    .replacementGlyphCode = replacementGlyphCode});
                 }
             }
+            if ((glyphCode != NO_GLYPH_CODE) && (glyphCode < face->header->glyphCount)) {
+                face->ligSteps.set(glyphCode, ligSteps.data(), ligSteps.size());
+            }
+        }
+        if (face->ligKernIndex.built()) {
+            face->ligKernIndex.build(face->ligSteps, face->kernSteps);
         }
     }
 }
@@ -1201,6 +1375,8 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
                                           IBMFFontModPtr fromBackup, IBMFFontModPtr toBackup,
                                           IBMFFontModPtr thisFont) -> void {
 
+    ensureBitmaps();
+
     stream << "Font " << fontName << std::endl
            << "Importing Font Modifications from File " << fileName << ":" << std::endl;
 
@@ -1232,23 +1408,23 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
             // For each code point that is part of the backup
             for (int bidx = 0; bidx < backupFace->header->glyphCount; bidx++) {
 
-                auto &bGlyph = backupFace->backupGlyphs[bidx];
-                uint16_t glyphCode = translate(bGlyph->codePoint);
+                const BackupGlyphInfo &bGlyph = backupFace->backupGlyphs[bidx];
+                uint16_t glyphCode = translate(bGlyph.codePoint);
 
                 // If the code point is absent from the current font, but is
                 // a user defined code point, add it to the font, and
                 // retrieve it's glyphCode (it's index in the font)
                 if (((glyphCode == NO_GLYPH_CODE) || (glyphCode == SPACE_CODE)) &&
-                    ((bGlyph->codePoint >= 0xE000) && (bGlyph->codePoint <= 0xF8FF))) {
-                    addCodePoint(toBackup, thisFont, bGlyph->codePoint);
-                    glyphCode = translate(bGlyph->codePoint);
+                    ((bGlyph.codePoint >= 0xE000) && (bGlyph.codePoint <= 0xF8FF))) {
+                    addCodePoint(toBackup, thisFont, bGlyph.codePoint);
+                    glyphCode = translate(bGlyph.codePoint);
                     if (firstUserCodePointAddedGlyphCode == 0) {
                         firstUserCodePointAddedGlyphCode = glyphCode;
                     }
                     addedUserCodePointsCount += 1;
                 }
 
-                uint16_t mainGlyphCode = translate(bGlyph->mainCodePoint);
+                uint16_t mainGlyphCode = translate(bGlyph.mainCodePoint);
 
                 if ((glyphCode != NO_GLYPH_CODE) && (glyphCode != SPACE_CODE)) {
                     bool modified = false;
@@ -1256,13 +1432,13 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
                     // Generate new GlyphInfo
 
                     auto newInfo =
-                        GlyphInfoPtr(new GlyphInfo{.bitmapWidth = bGlyph->bitmapWidth,
-                                                   .bitmapHeight = bGlyph->bitmapHeight,
-                                                   .horizontalOffset = bGlyph->horizontalOffset,
-                                                   .verticalOffset = bGlyph->verticalOffset,
-                                                   .packetLength = bGlyph->packetLength,
-                                                   .advance = bGlyph->advance,
-                                                   .rleMetrics = bGlyph->rleMetrics,
+                        GlyphInfoPtr(new GlyphInfo{.bitmapWidth = bGlyph.bitmapWidth,
+                                                   .bitmapHeight = bGlyph.bitmapHeight,
+                                                   .horizontalOffset = bGlyph.horizontalOffset,
+                                                   .verticalOffset = bGlyph.verticalOffset,
+                                                   .packetLength = bGlyph.packetLength,
+                                                   .advance = bGlyph.advance,
+                                                   .rleMetrics = bGlyph.rleMetrics,
                                                    .ligKernPgmIndex = 0,
                                                    .mainCode = ((mainGlyphCode == SPACE_CODE) ||
                                                                 (mainGlyphCode == NO_GLYPH_CODE))
@@ -1270,20 +1446,19 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
                                                                    : mainGlyphCode});
                     if ((mainGlyphCode == SPACE_CODE) || (mainGlyphCode == NO_GLYPH_CODE)) {
                         modified = true;
-                        stream << "For codepoint " << bGlyph->codePoint
-                               << ", main codepoint absent from the font: " << bGlyph->mainCodePoint
+                        stream << "For codepoint " << bGlyph.codePoint
+                               << ", main codepoint absent from the font: " << bGlyph.mainCodePoint
                                << std::endl;
                     }
 
                     // Generate Bitmap
 
-                    auto newBitmap = BitmapPtr(new Bitmap(backupFace->bitmaps[bidx]->pixels,
-                                                          backupFace->bitmaps[bidx]->dim));
+                    auto newBitmap = backupFace->bitmaps.get(bidx);
 
                     // Ligatures and Kernings
 
                     auto newLigKern = GlyphLigKernPtr(new GlyphLigKern);
-                    auto &blk = backupFace->backupGlyphsLigKern[bidx];
+                    auto blk = backupFace->getBackupLigKern(bidx);
 
                     // Ligatures will be recomputed from the pre-defined table after
                     // this for loop
@@ -1321,9 +1496,9 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
                         }
                     }
 
-                    *face->glyphs[glyphCode] = *newInfo;
-                    *face->bitmaps[glyphCode] = *newBitmap;
-                    *face->glyphsLigKern[glyphCode] = *newLigKern;
+                    face->glyphs[glyphCode] = *newInfo;
+                    face->bitmaps.set(glyphCode, *newBitmap);
+                    face->setLigKern(glyphCode, *newLigKern);
 
                     toBackup->saveGlyph(faceIdx, glyphCode, newInfo, newBitmap, newLigKern,
                                         thisFont);
@@ -1334,7 +1509,7 @@ auto IBMFFontMod::importModificationsFrom(std::ostream &stream, std::string font
                     }
                 } else {
                     rejected += 1;
-                    stream << "Code point " << bGlyph->codePoint
+                    stream << "Code point " << bGlyph.codePoint
                            << " is not part of the font. Entry rejected." << std::endl;
                 }
             }
@@ -1358,13 +1533,19 @@ auto IBMFFontMod::glyphIsModified(int faceIdx, GlyphCode glyphCode, BitmapPtr &b
                                   GlyphInfoPtr &glyphInfo, GlyphLigKernPtr &ligKern) const -> bool {
     FacePtr face = faces_[faceIdx];
 
-    return !((*face->glyphs[glyphCode] == *glyphInfo) && (*face->bitmaps[glyphCode] == *bitmap) &&
-             (*face->glyphsLigKern[glyphCode] == *ligKern));
+    bool sameBitmap = preEncoded_ ? (*glyphBitmap(faceIdx, glyphCode) == *bitmap)
+                                  : face->bitmaps.same(glyphCode, *bitmap);
+
+    return !((face->glyphs[glyphCode] == *glyphInfo) && sameBitmap &&
+             face->sameLigKern(glyphCode, *ligKern));
 }
 
 auto IBMFFontMod::buildModificationsFrom(std::ostream &stream, IBMFFontModPtr fromFont,
                                          IBMFFontModPtr thisFont) -> IBMFFontModPtr {
 
+    ensureBitmaps();
+    fromFont->ensureBitmaps();
+
     if (thisFont.get() != this) {
         stream << "Internal application error: "
                << "Wrong parameter for thisFont." << std::endl
@@ -1377,13 +1558,9 @@ auto IBMFFontMod::buildModificationsFrom(std::ostream &stream, IBMFFontModPtr fr
     auto backup = IBMFFontMod::createBackup();
 
     auto saveGlyph = [thisFont, backup](int faceIdx, FacePtr face, GlyphCode glyphCode) -> void {
-        auto newGlyphInfo = GlyphInfoPtr(new GlyphInfo);
-        auto newBitmap = BitmapPtr(new Bitmap);
-        auto newGlyphLigKern = GlyphLigKernPtr(new GlyphLigKern);
-
-        *newGlyphInfo = *face->glyphs[glyphCode];
-        *newBitmap = *face->bitmaps[glyphCode];
-        *newGlyphLigKern = *face->glyphsLigKern[glyphCode];
+        auto newGlyphInfo = GlyphInfoPtr(new GlyphInfo(face->glyphs[glyphCode]));
+        auto newBitmap = face->bitmaps.get(glyphCode);
+        auto newGlyphLigKern = face->getLigKern(glyphCode);
 
         backup->saveGlyph(faceIdx, glyphCode, newGlyphInfo, newBitmap, newGlyphLigKern, thisFont);
     };
@@ -1394,14 +1571,14 @@ auto IBMFFontMod::buildModificationsFrom(std::ostream &stream, IBMFFontModPtr fr
     for (auto &face : faces_) {
         FacePtr fromFace = fromFont->findFace(face->header->pointSize);
         if (fromFace != nullptr) {
-            for (uint16_t glyphCode = 0; glyphCode < face->header->glyphCount; glyphCode++) {
-                char32_t glyphCodePoint = getUTF32(glyphCode);
+            for (auto [glyphCode, glyphCodePoint] : codePoints()) {
+                if (glyphCode >= face->header->glyphCount) break;
                 uint16_t fromGlyphCode = fromFont->translate(glyphCodePoint);
                 if ((fromGlyphCode != SPACE_CODE) && (fromGlyphCode != NO_GLYPH_CODE)) {
-                    if (!((*face->glyphs[glyphCode] == *fromFace->glyphs[fromGlyphCode]) &&
-                          (*face->bitmaps[glyphCode] == *fromFace->bitmaps[fromGlyphCode]) &&
-                          (*face->glyphsLigKern[glyphCode] ==
-                           *fromFace->glyphsLigKern[fromGlyphCode]))) {
+                    if (!((face->glyphs[glyphCode] == fromFace->glyphs[fromGlyphCode]) &&
+                          face->bitmaps.same(glyphCode, fromFace->bitmaps, fromGlyphCode) &&
+                          face->ligSteps.same(glyphCode, fromFace->ligSteps, fromGlyphCode) &&
+                          face->kernSteps.same(glyphCode, fromFace->kernSteps, fromGlyphCode))) {
 
                         saveGlyph(faceIdx, face, glyphCode);
                         modifCount += 1;
@@ -1410,7 +1587,7 @@ auto IBMFFontMod::buildModificationsFrom(std::ostream &stream, IBMFFontModPtr fr
                     saveGlyph(faceIdx, face, glyphCode);
                     modifCount += 1;
                 } else {
-                    stream << "Codepoint " << +getUTF32(glyphCode) << " not present in Old Font."
+                    stream << "Codepoint " << +glyphCodePoint << " not present in Old Font."
                            << std::endl;
                 }
             }
@@ -1430,32 +1607,40 @@ auto IBMFFontMod::buildModificationsFrom(std::ostream &stream, IBMFFontModPtr fr
 
 auto IBMFFontMod::createBundleCodePointEntry(char16_t cPoint) -> void {
 
-    // Find in which bundle the codePoint must be integrated
-    int bundleIdx = 0;
-    while (bundleIdx < codePointBundles_.size()) {
-        if (codePointBundles_[bundleIdx].firstCodePoint > cPoint) {
-            break;
-        }
-        bundleIdx += 1;
-    }
+    // Find in which bundle of plane 0 the codePoint must be integrated
+    auto first = codePointBundles_.begin();
+    auto last = first + planes_[0].entriesCount;
+    int bundleIdx = std::partition_point(first, last,
+                                         [cPoint](const CodePointBundle &b) {
+                                             return b.firstCodePoint <= cPoint;
+                                         }) -
+                    first;
     if (bundleIdx > 0) {
         bundleIdx -= 1;
     }
 
     // Check if the codePoint can be integrated to this bundle. If yes, do it. If no
-    // add a new bundle
+    // add a new bundle. The glyph codes of the following bundles are shifted by one.
 
     if (codePointBundles_[bundleIdx].lastCodePoint == (cPoint - 1)) {
         codePointBundles_[bundleIdx].lastCodePoint = cPoint;
     } else {
         CodePointBundle newBundle{.firstCodePoint = cPoint, .lastCodePoint = cPoint};
-        codePointBundles_.insert(codePointBundles_.begin() + (bundleIdx + 1), newBundle);
+        GlyphCode glyphCode = bundleGlyphCodes_[bundleIdx] +
+                              (codePointBundles_[bundleIdx].lastCodePoint -
+                               codePointBundles_[bundleIdx].firstCodePoint + 1);
+        bundleIdx += 1;
+        codePointBundles_.insert(codePointBundles_.begin() + bundleIdx, newBundle);
+        bundleGlyphCodes_.insert(bundleGlyphCodes_.begin() + bundleIdx, glyphCode);
         planes_[0].entriesCount += 1;
         for (int i = 1; i < 4; i++) {
             planes_[i].codePointBundlesIdx += 1;
         }
     }
 
+    for (int i = bundleIdx + 1; i < bundleGlyphCodes_.size(); i++) {
+        bundleGlyphCodes_[i] += 1;
+    }
     for (int i = 1; i < 4; i++) {
         planes_[i].firstGlyphCode += 1;
     }
@@ -1464,6 +1649,8 @@ auto IBMFFontMod::createBundleCodePointEntry(char16_t cPoint) -> void {
 auto IBMFFontMod::addCodePoint(IBMFFontModPtr backup, IBMFFontModPtr font, char32_t codePoint)
     -> char32_t {
 
+    ensureBitmaps();
+
     // If no specific private-use code point is required, find the next available
     // code point
 
@@ -1503,9 +1690,9 @@ auto IBMFFontMod::addCodePoint(IBMFFontModPtr backup, IBMFFontModPtr font, char3
         auto newGlyphLigKern = GlyphLigKernPtr(new GlyphLigKern);
 
         face->header->glyphCount += 1;
-        face->glyphs.insert(face->glyphs.begin() + glyphCode, newGlyphInfo);
-        face->bitmaps.insert(face->bitmaps.begin() + glyphCode, newBitmap);
-        face->glyphsLigKern.insert(face->glyphsLigKern.begin() + glyphCode, newGlyphLigKern);
+        face->glyphs.insert(face->glyphs.begin() + glyphCode, *newGlyphInfo);
+        face->bitmaps.insert(glyphCode, *newBitmap);
+        face->insertLigKern(glyphCode, *newGlyphLigKern);
 
         backup->saveGlyph(faceIdx, glyphCode, newGlyphInfo, newBitmap, newGlyphLigKern, font);
 
@@ -3,10 +3,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <vector>
 
+#include "BitmapCache.hpp"
+#include "BitmapCodec.hpp"
+#include "GlyphArena.hpp"
 #include "IBMFDefs.hpp"
+#include "LigKernIndex.hpp"
 
 using namespace ibmf_defs;
 
@@ -33,26 +38,145 @@ typedef std::shared_ptr<IBMFFontMod> IBMFFontModPtr;
  */
 class IBMFFontMod {
 public:
+    // The glyphs' data is kept in contiguous arrays, all indexed by glyphCode.
     struct Face {
         FaceHeaderPtr header;
-        std::vector<GlyphInfoPtr> glyphs; // Not used with BAKCUP format
-        std::vector<BitmapPtr> bitmaps;
-        std::vector<GlyphLigKernPtr> glyphsLigKern; // Specific to each glyph
+        std::vector<GlyphInfo> glyphs; // Not used with BAKCUP format
+        BitmapArena bitmaps;
+        GlyphArena<GlyphLigStep> ligSteps; // Specific to each glyph
+        GlyphArena<GlyphKernStep> kernSteps;
         // used ontly at save and load time
-        std::vector<RLEBitmapPtr> compressedBitmaps; // Todo: maybe unused at the end
+        GlyphArena<uint8_t> compressedBitmaps; // Only with pre-encoded bitmaps
 
         // used only at save time
         std::vector<LigKernStep> ligKernSteps; // The complete list of lig/kerns
 
+        // Optional, see buildLigKernIndex()
+        LigKernIndex ligKernIndex;
+
         // Only used with BACKUP format
-        std::vector<BackupGlyphInfoPtr> backupGlyphs;
-        std::vector<BackupGlyphLigKernPtr> backupGlyphsLigKern;
+        std::vector<BackupGlyphInfo> backupGlyphs;
+        GlyphArena<BackupGlyphLigStep> backupLigSteps;
+        GlyphArena<BackupGlyphKernStep> backupKernSteps;
+
+        auto getLigKern(GlyphCode glyphCode) const -> GlyphLigKernPtr {
+            GlyphLigKernPtr glyphLigKern = GlyphLigKernPtr(new GlyphLigKern);
+            glyphLigKern->ligSteps.assign(ligSteps.begin(glyphCode), ligSteps.end(glyphCode));
+            glyphLigKern->kernSteps.assign(kernSteps.begin(glyphCode), kernSteps.end(glyphCode));
+            return glyphLigKern;
+        }
+
+        void setLigKern(GlyphCode glyphCode, const GlyphLigKern &glyphLigKern) {
+            ligKernIndex.clear();
+            ligSteps.set(glyphCode, glyphLigKern.ligSteps.data(), glyphLigKern.ligSteps.size());
+            kernSteps.set(glyphCode, glyphLigKern.kernSteps.data(), glyphLigKern.kernSteps.size());
+        }
+
+        void insertLigKern(GlyphCode glyphCode, const GlyphLigKern &glyphLigKern) {
+            ligKernIndex.clear();
+            ligSteps.insert(glyphCode, glyphLigKern.ligSteps.data(), glyphLigKern.ligSteps.size());
+            kernSteps.insert(glyphCode, glyphLigKern.kernSteps.data(),
+                             glyphLigKern.kernSteps.size());
+        }
+
+        auto sameLigKern(GlyphCode glyphCode, const GlyphLigKern &glyphLigKern) const -> bool {
+            return ligSteps.same(glyphCode, glyphLigKern.ligSteps) &&
+                   kernSteps.same(glyphCode, glyphLigKern.kernSteps);
+        }
+
+        auto getBackupLigKern(GlyphCode glyphCode) const -> BackupGlyphLigKernPtr {
+            BackupGlyphLigKernPtr glyphLigKern = BackupGlyphLigKernPtr(new BackupGlyphLigKern);
+            glyphLigKern->ligSteps.assign(backupLigSteps.begin(glyphCode),
+                                          backupLigSteps.end(glyphCode));
+            glyphLigKern->kernSteps.assign(backupKernSteps.begin(glyphCode),
+                                           backupKernSteps.end(glyphCode));
+            return glyphLigKern;
+        }
     };
 
     typedef std::shared_ptr<Face> FacePtr;
 
-    IBMFFontMod(uint8_t *memoryFont, uint32_t size) : memory_(memoryFont), memoryLength_(size) {
-        initialized_ = load();
+    // Read-only access to a glyph's data, as retrieved by getGlyphView(), without
+    // any copy. It points into the face's arrays and stays valid up to the next
+    // modification of the font (saveGlyph(), addCodePoint(), import, ...).
+    struct GlyphView {
+        const GlyphInfo *glyphInfo{nullptr};
+        Dim dim;
+        const uint8_t *pixels{nullptr}; // dim.width * dim.height pixels
+        const GlyphLigStep *ligSteps{nullptr};
+        uint32_t ligCount{0};
+        const GlyphKernStep *kernSteps{nullptr};
+        uint32_t kernCount{0};
+
+        // With lazy loading, the bitmap decoded on demand, kept alive for pixels
+        BitmapPtr decodedBitmap;
+    };
+
+    // Forward iterator on the (glyphCode, codePoint) pairs of a UTF32 font, in
+    // glyph code order. Walks the code point bundles in sequence, without any
+    // lookup nor allocation. Invalidated by addCodePoint().
+    class CodePointIterator {
+    public:
+        typedef std::pair<GlyphCode, char32_t> value_type;
+
+        CodePointIterator(const IBMFFontMod *font, int bundleIdx)
+            : font_(font), bundleIdx_(bundleIdx) {
+            settlePlane();
+        }
+
+        inline auto operator*() const -> value_type {
+            return {static_cast<GlyphCode>(font_->bundleGlyphCodes_[bundleIdx_] + offset_),
+                    (static_cast<char32_t>(planeIdx_) << 16) |
+                        (font_->codePointBundles_[bundleIdx_].firstCodePoint + offset_)};
+        }
+
+        inline auto operator++() -> CodePointIterator & {
+            const CodePointBundle &bundle = font_->codePointBundles_[bundleIdx_];
+            if (++offset_ > (bundle.lastCodePoint - bundle.firstCodePoint)) {
+                offset_ = 0;
+                bundleIdx_ += 1;
+                settlePlane();
+            }
+            return *this;
+        }
+
+        inline auto operator==(const CodePointIterator &other) const -> bool {
+            return (bundleIdx_ == other.bundleIdx_) && (offset_ == other.offset_);
+        }
+        inline auto operator!=(const CodePointIterator &other) const -> bool {
+            return !(*this == other);
+        }
+
+    private:
+        const IBMFFontMod *font_;
+        int bundleIdx_;
+        int offset_{0}; // In the bundle
+        int planeIdx_{0};
+
+        // Moves planeIdx_ to the plane of the current bundle
+        inline void settlePlane() {
+            if (bundleIdx_ >= (int)font_->codePointBundles_.size()) return;
+            while ((planeIdx_ < 3) &&
+                   (bundleIdx_ >= (font_->planes_[planeIdx_].codePointBundlesIdx +
+                                   font_->planes_[planeIdx_].entriesCount))) {
+                planeIdx_ += 1;
+            }
+        }
+    };
+
+    struct CodePoints {
+        CodePointIterator first, last;
+        inline auto begin() const -> CodePointIterator { return first; }
+        inline auto end() const -> CodePointIterator { return last; }
+    };
+
+    // With lazy set, the glyphs' bitmaps are kept compressed when loaded and are
+    // decoded on demand by getGlyph(), getGlyphView() and showFace(), through a
+    // bitmap cache bounded by setBitmapCacheBudget(). Any modification of the
+    // font decodes all bitmaps. Not used with BACKUP format.
+    IBMFFontMod(uint8_t *memoryFont, uint32_t size, bool lazy = false)
+        : memory_(memoryFont), memoryLength_(size) {
+        initialized_ = load(lazy);
         lastError_ = 0;
     }
 
@@ -85,6 +209,19 @@ public:
     inline auto getFontFormat() const -> FontFormat { return preamble_.bits.fontFormat; }
     inline auto isInitialized() const -> bool { return initialized_; }
     inline auto getLastError() const -> int { return lastError_; }
+
+    // Number of threads used by save() to encode the bitmaps, and by the import
+    // methods of the derived classes. 0 means one thread per core.
+    inline void setThreadCount(int count) { threadCount_ = count; }
+
+    // Codecs used by save() to encode the bitmaps (see BitmapCodec.hpp). Not used
+    // with pre-encoded bitmaps.
+    inline void setCodecOptions(const CodecOptions &options) { codecOptions_ = options; }
+
+    // Maximum size in bytes of the bitmaps decoded on demand that are retained
+    inline void setBitmapCacheBudget(size_t bytes) { bitmapCache_.setBudget(bytes); }
+    inline auto getBitmapCache() const -> const BitmapCache & { return bitmapCache_; }
+
     inline auto getLineHeight(int faceIdx) const -> int {
         return ((faceIdx >= 0) && (faceIdx < preamble_.faceCount))
                    ? faces_[faceIdx]->header->lineHeight
@@ -96,11 +233,20 @@ public:
                                                                    : nullptr;
     }
 
-    inline auto characterCodes() const -> const CharCodes * {
-        CharCodes *chCodes = new CharCodes;
-        for (GlyphCode i = 0; i < faces_[0]->header->glyphCount; i++) {
-            char32_t ch = getUTF32(i);
-            chCodes->push_back(ch);
+    // The (glyphCode, codePoint) pairs of the font:
+    //
+    //   for (auto [glyphCode, codePoint] : font.codePoints()) ...
+    inline auto codePoints() const -> CodePoints {
+        return CodePoints{CodePointIterator(this, 0),
+                          CodePointIterator(this, codePointBundles_.size())};
+    }
+
+    // The code points of the font, in glyph code order
+    inline auto characterCodes() const -> CharCodes {
+        CharCodes chCodes;
+        chCodes.reserve(faces_[0]->header->glyphCount);
+        for (auto [glyphCode, codePoint] : codePoints()) {
+            chCodes.push_back(codePoint);
         }
         return chCodes;
     }
@@ -108,10 +254,16 @@ public:
     auto findFace(uint8_t pointSize) -> FacePtr;
     auto findGlyphIndex(FacePtr face, char32_t codePoint) -> int;
 
+    // Indexes the faces' lig/kern steps for ligKern(), a layout engine calling it
+    // for each pair of glyphs. The index is kept up to date by
+    // recomputeLigatures() and dropped by the other modifications of the steps.
+    auto buildLigKernIndex() -> void;
     auto ligKern(int faceIndex, const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern,
                  bool *kernPairPresent, GlyphLigKernPtr bypassLigKern = nullptr) const -> bool;
     auto getGlyph(int faceIndex, int glyphCode, GlyphInfoPtr &glyphInfo, BitmapPtr &bitmap,
                   GlyphLigKernPtr &glyphLigKern) const -> bool;
+    // Same as getGlyph(), without copy. Can be used by concurrent readers.
+    auto getGlyphView(int faceIndex, int glyphCode, GlyphView &view) const -> bool;
     auto saveFaceHeader(int faceIndex, FaceHeader &face_header) -> bool;
     // The font parameter is only used with the BACKUP format
     auto saveGlyph(int faceIndex, int glyphCode, GlyphInfoPtr newGlyphInfo, BitmapPtr newBitmap,
@@ -125,9 +277,9 @@ public:
     auto showBitmap(std::ostream &stream, const BitmapPtr bitmap) const -> void;
     auto showBackupLigKerns(std::ostream &stream, BackupGlyphLigKernPtr lk) const -> void;
     auto showLigKerns(std::ostream &stream, GlyphLigKernPtr lk) const -> void;
-    auto showBackupGlyphInfo(std::ostream &stream, GlyphCode i, const BackupGlyphInfoPtr g) const
+    auto showBackupGlyphInfo(std::ostream &stream, GlyphCode i, const BackupGlyphInfo &g) const
         -> void;
-    auto showGlyphInfo(std::ostream &stream, GlyphCode i, const GlyphInfoPtr g) const -> void;
+    auto showGlyphInfo(std::ostream &stream, GlyphCode i, const GlyphInfo &g) const -> void;
     auto showFace(std::ostream &stream, FacePtr face, bool withBitmaps) const -> void;
     auto showCodePointBundles(std::ostream &stream, int firstIdx, int count) const -> void;
     auto showPlanes(std::ostream &stream) const -> void;
@@ -156,6 +308,32 @@ protected:
     std::vector<CodePointBundle> codePointBundles_;
     std::vector<FacePtr> faces_;
 
+    // Glyph code of the first code point of each bundle, derived from planes_ and
+    // codePointBundles_ (not saved). Lets translate(), toGlyphCode() and getUTF32()
+    // binary search the bundles of a plane.
+    std::vector<GlyphCode> bundleGlyphCodes_;
+
+    // To be called once the planes and bundles are completely defined
+    auto buildGlyphCodeIndex() -> void;
+
+    // When true, the faces' compressedBitmaps contain the final RLE encoded bitmaps
+    // (with rleMetrics and packetLength already set in the glyphs) and the bitmaps
+    // only carry their dimensions. The save() method then copies the RLE data as is.
+    // ensureBitmaps() must be called before any access to the bitmaps' pixels,
+    // unless done through glyphBitmap().
+    mutable bool preEncoded_{false};
+
+    // The bitmaps decoded by glyphBitmap() while preEncoded_ is true
+    mutable BitmapCache bitmapCache_;
+    mutable std::mutex bitmapCacheMutex_;
+
+    auto ensureBitmaps() const -> void;
+    auto decodeBitmap(const FacePtr &face, GlyphCode glyphCode, MemoryPtr pixels) const -> void;
+    auto glyphBitmap(int faceIdx, GlyphCode glyphCode) const -> BitmapPtr;
+
+    int threadCount_{1};
+    CodecOptions codecOptions_;
+
 private:
     bool initialized_;
 
@@ -166,7 +344,7 @@ private:
 
     int lastError_;
 
-    auto findList(std::vector<LigKernStep> &pgm, std::vector<LigKernStep> &list) const -> int;
+    auto findGlyphCode(char32_t codePoint, GlyphCode notFound) const -> GlyphCode;
     auto prepareLigKernVectors() -> bool;
-    auto load() -> bool;
+    auto load(bool lazy) -> bool;
 };
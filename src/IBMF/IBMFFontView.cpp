@@ -0,0 +1,169 @@
+#include "IBMFFontView.hpp"
+
+#include <cstring>
+
+#include "../Misc/log.hpp"
+
+auto IBMFFontView::open(const std::string &filePath) -> bool {
+    close();
+
+    // The glyphs are accessed in any order
+    if (!file_.open(filePath, false)) return false;
+
+    const uint8_t *memory = file_.data();
+    size_t size = file_.size();
+
+    // Preamble
+    if ((size < sizeof(Preamble)) || (strncmp("IBMF", (const char *)memory, 4) != 0)) {
+        log_e("Not a IBMF font: %s", filePath.c_str());
+        close();
+        return false;
+    }
+    const Preamble *preamble = reinterpret_cast<const Preamble *>(memory);
+    if (preamble->bits.version != IBMF_VERSION) {
+        log_e("Unsupported IBMF version %d: %s", preamble->bits.version, filePath.c_str());
+        close();
+        return false;
+    }
+
+    // Faces offsets
+    size_t idx = ((sizeof(Preamble) + preamble->faceCount + 3) & 0xFFFFFFFC);
+    if ((idx + (4 * preamble->faceCount)) > size) {
+        log_e("Truncated IBMF font: %s", filePath.c_str());
+        close();
+        return false;
+    }
+    const uint32_t *faceOffsets = reinterpret_cast<const uint32_t *>(&memory[idx]);
+    idx += 4 * preamble->faceCount;
+
+    // Unicode CodePoint Table
+    if (preamble->bits.fontFormat == FontFormat::UTF32) {
+        if ((idx + sizeof(Planes)) > size) {
+            log_e("Truncated IBMF font: %s", filePath.c_str());
+            close();
+            return false;
+        }
+        const Plane *planes = reinterpret_cast<const Plane *>(&memory[idx]);
+        idx += sizeof(Planes);
+
+        size_t bundleCount = planes[3].codePointBundlesIdx + planes[3].entriesCount;
+        if ((idx + (bundleCount * sizeof(CodePointBundle))) > size) {
+            log_e("Truncated IBMF font: %s", filePath.c_str());
+            close();
+            return false;
+        }
+        planes_ = Span<Plane>(planes, 4);
+        codePointBundles_ =
+            Span<CodePointBundle>(reinterpret_cast<const CodePointBundle *>(&memory[idx]),
+                                  bundleCount);
+        idx += bundleCount * sizeof(CodePointBundle);
+    }
+
+    // Faces
+    faces_.resize(preamble->faceCount);
+    for (int i = 0; i < preamble->faceCount; i++) {
+        uint32_t nextOffset = (i + 1) < preamble->faceCount ? faceOffsets[i + 1] : size;
+        if ((faceOffsets[i] != idx) ||
+            !locateFace(faceOffsets[i], nextOffset,
+                        preamble->bits.fontFormat == FontFormat::BACKUP, faces_[i])) {
+            log_e("Face %d of %s is corrupted.", i, filePath.c_str());
+            close();
+            return false;
+        }
+        idx = nextOffset;
+    }
+
+    preamble_ = preamble;
+    return true;
+}
+
+// Sets the spans of the face located at offset. The face must end at nextOffset.
+auto IBMFFontView::locateFace(uint32_t offset, uint32_t nextOffset, bool backup, FaceView &face)
+    -> bool {
+    const uint8_t *memory = file_.data();
+    size_t idx = offset;
+
+    if ((nextOffset > file_.size()) || ((idx + sizeof(FaceHeader)) > nextOffset)) return false;
+    face.header = reinterpret_cast<const FaceHeader *>(&memory[idx]);
+    idx += sizeof(FaceHeader);
+
+    const uint16_t glyphCount = face.header->glyphCount;
+    const size_t glyphInfoSize = backup ? sizeof(BackupGlyphInfo) : sizeof(GlyphInfo);
+    const size_t ligKernSize = backup ? 0 : face.header->ligKernStepCount * sizeof(LigKernStep);
+
+    if ((idx + (glyphCount * (sizeof(PixelPoolIndex) + glyphInfoSize)) +
+         face.header->pixelsPoolSize + ligKernSize) > nextOffset) {
+        return false;
+    }
+
+    face.poolIndexes =
+        Span<PixelPoolIndex>(reinterpret_cast<const PixelPoolIndex *>(&memory[idx]), glyphCount);
+    idx += glyphCount * sizeof(PixelPoolIndex);
+
+    if (backup) {
+        face.backupGlyphs = Span<BackupGlyphInfo>(
+            reinterpret_cast<const BackupGlyphInfo *>(&memory[idx]), glyphCount);
+    } else {
+        face.glyphs =
+            Span<GlyphInfo>(reinterpret_cast<const GlyphInfo *>(&memory[idx]), glyphCount);
+    }
+    idx += glyphCount * glyphInfoSize;
+
+    face.pixelsPool = Span<uint8_t>(&memory[idx], face.header->pixelsPoolSize);
+    idx += face.header->pixelsPoolSize;
+
+    if (backup) {
+        face.ligKernData = Span<uint8_t>(&memory[idx], nextOffset - idx);
+    } else {
+        face.ligKernSteps = Span<LigKernStep>(reinterpret_cast<const LigKernStep *>(&memory[idx]),
+                                              face.header->ligKernStepCount);
+    }
+
+    return true;
+}
+
+void IBMFFontView::close() {
+    preamble_ = nullptr;
+    planes_ = Span<Plane>();
+    codePointBundles_ = Span<CodePointBundle>();
+    faces_.clear();
+    file_.close();
+}
+
+auto IBMFFontView::getRLEBitmap(int faceIdx, GlyphCode glyphCode, RLEBitmapView &rleBitmap,
+                                RLEMetrics &rleMetrics) const -> bool {
+    const FaceView *face = getFace(faceIdx);
+    if ((face == nullptr) || (glyphCode >= face->header->glyphCount)) return false;
+
+    uint32_t poolIndex = face->poolIndexes[glyphCode];
+    uint16_t packetLength;
+    if (getFontFormat() == FontFormat::BACKUP) {
+        const BackupGlyphInfo &glyph = face->backupGlyphs[glyphCode];
+        rleBitmap.dim = Dim(glyph.bitmapWidth, glyph.bitmapHeight);
+        rleMetrics = glyph.rleMetrics;
+        packetLength = glyph.packetLength;
+    } else {
+        const GlyphInfo &glyph = face->glyphs[glyphCode];
+        rleBitmap.dim = Dim(glyph.bitmapWidth, glyph.bitmapHeight);
+        rleMetrics = glyph.rleMetrics;
+        packetLength = glyph.packetLength;
+    }
+    if ((poolIndex + packetLength) > face->pixelsPool.size()) return false;
+
+    rleBitmap.data = face->pixelsPool.data() + poolIndex;
+    rleBitmap.length = packetLength;
+    return true;
+}
+
+auto IBMFFontView::getBitmap(int faceIdx, GlyphCode glyphCode, Bitmap &bitmap) const -> bool {
+    RLEBitmapView rleBitmap(nullptr, 0, Dim(0, 0));
+    RLEMetrics rleMetrics;
+    if (!getRLEBitmap(faceIdx, glyphCode, rleBitmap, rleMetrics)) return false;
+
+    bitmap.dim = rleBitmap.dim;
+    bitmap.pixels = Pixels(bitmap.dim.width * bitmap.dim.height, 0);
+    if (rleBitmap.length == 0) return true;
+
+    RLEExtractor rle;
+    return rle.retrieveBitmap(rleBitmap, bitmap, Pos(0, 0), rleMetrics);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "IBMFDefs.hpp"
+
+using namespace ibmf_defs;
+
+#include "../Misc/MappedFile.hpp"
+#include "RLEExtractor.hpp"
+
+/**
+ * @brief Read-only access to a IBMF font file, without any copy.
+ *
+ * The font file is memory mapped and its parts (preamble, code point tables,
+ * faces' header, glyphs' information, pixels pool and lig/kern steps) are
+ * accessed in place, through spans pointing into the mapping. Opening a font
+ * only locates the faces, such that it takes the same time and memory whatever
+ * the font's size. The bitmaps are decoded on demand.
+ *
+ * To be used by verification and preview tools. To modify a font, IBMFFontMod
+ * is to be used.
+ *
+ */
+class IBMFFontView {
+public:
+    // A non-owning view of count consecutive T located in the mapping.
+    template <typename T> class Span {
+    private:
+        const T *data_{nullptr};
+        size_t size_{0};
+
+    public:
+        Span() = default;
+        Span(const T *data, size_t size) : data_(data), size_(size) {}
+
+        [[nodiscard]] inline auto data() const -> const T * { return data_; }
+        [[nodiscard]] inline auto size() const -> size_t { return size_; }
+        [[nodiscard]] inline auto empty() const -> bool { return size_ == 0; }
+        [[nodiscard]] inline auto begin() const -> const T * { return data_; }
+        [[nodiscard]] inline auto end() const -> const T * { return data_ + size_; }
+        inline auto operator[](size_t idx) const -> const T & { return data_[idx]; }
+    };
+
+    struct FaceView {
+        const FaceHeader *header{nullptr};
+        Span<PixelPoolIndex> poolIndexes; // One for each glyph
+        Span<GlyphInfo> glyphs;           // Not used with BACKUP format
+        Span<BackupGlyphInfo> backupGlyphs; // Only used with BACKUP format
+        Span<uint8_t> pixelsPool;
+        // With the BACKUP format, each glyph's lig/kern steps (as given by its
+        // ligCount and kernCount) follow each other in ligKernData.
+        Span<LigKernStep> ligKernSteps; // Not used with BACKUP format
+        Span<uint8_t> ligKernData;      // Only used with BACKUP format
+    };
+
+    IBMFFontView() = default;
+    IBMFFontView(const std::string &filePath) { open(filePath); }
+
+    IBMFFontView(const IBMFFontView &) = delete;
+    auto operator=(const IBMFFontView &) -> IBMFFontView & = delete;
+
+    auto open(const std::string &filePath) -> bool;
+    void close();
+
+    [[nodiscard]] inline auto isOpen() const -> bool { return preamble_ != nullptr; }
+    [[nodiscard]] inline auto getPreamble() const -> const Preamble & { return *preamble_; }
+    [[nodiscard]] inline auto getFontFormat() const -> FontFormat {
+        return preamble_->bits.fontFormat;
+    }
+    [[nodiscard]] inline auto getFaceCount() const -> int { return faces_.size(); }
+
+    // Only used with UTF32 format
+    [[nodiscard]] inline auto getPlanes() const -> Span<Plane> { return planes_; }
+    [[nodiscard]] inline auto getCodePointBundles() const -> Span<CodePointBundle> {
+        return codePointBundles_;
+    }
+
+    [[nodiscard]] inline auto getFace(int faceIdx) const -> const FaceView * {
+        return ((faceIdx >= 0) && (faceIdx < (int)faces_.size())) ? &faces_[faceIdx] : nullptr;
+    }
+
+    // The glyph's RLE encoded bitmap, in the pixels pool
+    auto getRLEBitmap(int faceIdx, GlyphCode glyphCode, RLEBitmapView &rleBitmap,
+                      RLEMetrics &rleMetrics) const -> bool;
+
+    // Decodes the glyph's bitmap in a new bitmap
+    auto getBitmap(int faceIdx, GlyphCode glyphCode, Bitmap &bitmap) const -> bool;
+
+private:
+    static constexpr uint8_t IBMF_VERSION = 4;
+
+    MappedFile file_;
+
+    const Preamble *preamble_{nullptr};
+    Span<Plane> planes_;
+    Span<CodePointBundle> codePointBundles_;
+    std::vector<FaceView> faces_;
+
+    auto locateFace(uint32_t offset, uint32_t nextOffset, bool backup, FaceView &face) -> bool;
+};
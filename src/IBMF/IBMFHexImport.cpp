@@ -1,8 +1,14 @@
 #include "IBMFHexImport.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <map>
 
+#include "../Misc/GzLineReader.hpp"
+#include "../Misc/Parallel.hpp"
+#include "../Misc/StringUtil.hpp"
+
 enum Position { NONE, LEFT, RIGHT, CENTER };
 
 using PositionList = std::map<char32_t, Position>;
@@ -42,181 +48,179 @@ PositionList positionList = {
     {U'\U0000005F',  NONE}
 };
 
-auto IBMFHexImport::readCodePoint(std::fstream &in, char32_t &codePoint, uint32_t &firstBytes)
-    -> bool {
-
-  auto hex = [](char a) -> uint8_t { return ((a >= '0') && (a <= '9')) ? a - '0' : a - 'A' + 10; };
-
-  if (in.eof()) return false;
-
-  int i;
-  in >> std::hex >> i;
-
-  char ch;
-  in >> ch;
+static inline auto hexValue(char ch) -> int {
+  if ((ch >= '0') && (ch <= '9')) return ch - '0';
+  if ((ch >= 'A') && (ch <= 'F')) return ch - 'A' + 10;
+  if ((ch >= 'a') && (ch <= 'f')) return ch - 'a' + 10;
+  return -1;
+}
 
-  if (ch == ':') {
-    codePoint = static_cast<char32_t>(i);
-    char b1, b2, b3, b4;
-    in >> b1 >> b2 >> b3 >> b4;
-    firstBytes = (hex(b1) << 12) + (hex(b2) << 8) + (hex(b3) << 4) + hex(b4);
-    in >> b1 >> b2 >> b3 >> b4;
-    firstBytes = (firstBytes << 16) + (hex(b1) << 12) + (hex(b2) << 8) + (hex(b3) << 4) + hex(b4);
-    while (!in.eof() && (in.get() != '\n'))
-      ;
-    return true;
+// Retrieves the codePoint at the beginning of a hex file line and the
+// value of the first four bytes of the glyph (used by charSelected()).
+// On return, ptr is pointing at the first hex digit of the glyph.
+auto IBMFHexImport::readCodePoint(const char *&ptr, const char *lineEnd, char32_t &codePoint,
+                                  uint32_t &firstBytes) -> bool {
+  uint32_t value  = 0;
+  int      digits = 0;
+  int      v;
+
+  while ((ptr < lineEnd) && ((v = hexValue(*ptr)) >= 0)) {
+    value = (value << 4) + v;
+    digits += 1;
+    ptr++;
   }
-  return false;
+  if ((digits == 0) || (ptr >= lineEnd) || (*ptr != ':')) return false;
+  ptr++;
+
+  codePoint  = static_cast<char32_t>(value);
+  firstBytes = 0;
+  for (int i = 0; (i < 8) && ((ptr + i) < lineEnd); i++) {
+    if ((v = hexValue(ptr[i])) < 0) break;
+    firstBytes = (firstBytes << 4) + v;
+  }
+  return true;
 }
 
-auto IBMFHexImport::readOneGlyph(std::fstream &in, char32_t &codePoint, BitmapPtr bitmap,
-                                 int8_t &hOffset, int8_t &vOffset, uint16_t &advance) -> GlyphCode {
-  int  i;
-  auto hex = [](char a) -> uint8_t { return ((a >= '0') && (a <= '9')) ? a - '0' : a - 'A' + 10; };
-
-  in >> std::hex >> i;
+// Converts 8 hex digits to their 32 bits value, 8 digits at a time (SWAR). Returns
+// false if one of the characters is not an hex digit.
+static inline auto hexToUInt32(const char *ptr, uint32_t &value) -> bool {
+  constexpr uint64_t ONES  = 0x0101010101010101ULL;
+  constexpr uint64_t HIGHS = 0x8080808080808080ULL;
 
-  char ch;
-  in >> ch;
-  if (ch == ':') {
-    codePoint           = static_cast<char32_t>(i);
-    GlyphCode glyphCode = toGlyphCode(codePoint);
-    if (glyphCode == NO_GLYPH_CODE) goto noCode;
+  uint64_t v;
+  memcpy(&v, ptr, 8);
 
-    std::vector<uint8_t> bytes;
-    while (!in.eof() && (in.get() != '\n')) {
-      in.unget();
-      char b1, b2;
-      in >> b1 >> b2;
-      bytes.push_back((hex(b1) << 4) + hex(b2));
-    }
+  // A byte is flagged (bit 7) when it is in the ]m, n[ range. Valid for 7 bits values only.
+  auto between = [](uint64_t x, uint64_t m, uint64_t n) -> uint64_t {
+    uint64_t low7 = x & (ONES * 127);
+    return ((ONES * (127 + n)) - low7) & ~x & (low7 + (ONES * (127 - m))) & HIGHS;
+  };
+  uint64_t digits  = between(v, '0' - 1, '9' + 1);
+  uint64_t letters = between(v | (ONES * 0x20), 'a' - 1, 'f' + 1);
+  if ((v & HIGHS) || ((digits | letters) != HIGHS)) return false;
 
-    int byteWidth  = (bytes.size() == 16) ? 1 : 2;
-    int byteHeight = 16;
+  // '0'..'9' -> 0..9, 'A'..'F' and 'a'..'f' -> 10..15
+  v = (v & (ONES * 0x0F)) + (((v >> 6) & ONES) * 9);
 
-    advance        = (byteWidth == 2) ? 16 : 8;
+  // Memory order is most significant digit first: pack nibbles, then bytes, then words
+  v     = ((v << 4) | (v >> 8)) & 0x00FF00FF00FF00FFULL;
+  v     = ((v << 8) | (v >> 16)) & 0x0000FFFF0000FFFFULL;
+  value = static_cast<uint32_t>((v << 16) | (v >> 32));
 
-    if ((byteWidth * byteHeight) == bytes.size()) {
-      int firstRow, lastRow, firstCol, lastCol;
-      if (byteWidth == 1) {
-        for (firstRow = 0; firstRow < 16; firstRow++) {
-          if (bytes[firstRow] != 0) break;
-        }
-        if (firstRow >= 16) goto spaceCode;
-        for (lastRow = 15; lastRow >= 0; lastRow--) {
-          if (bytes[lastRow] != 0) break;
-        }
-        if (lastRow < 0) goto spaceCode; // Not really usefull...
-      } else {
-        for (firstRow = 0; firstRow < 16; firstRow++) {
-          if ((bytes[firstRow << 1] != 0) || (bytes[(firstRow << 1) + 1] != 0)) break;
-        }
-        if (firstRow >= 16) goto spaceCode;
-        for (lastRow = 15; lastRow >= 0; lastRow--) {
-          if ((bytes[lastRow << 1] != 0) || (bytes[(lastRow << 1) + 1] != 0)) break;
-        }
-        if (lastRow < 0) goto spaceCode; // Not really usefull...
-      }
+  return true;
+}
 
-      if (byteWidth == 1) {
-        uint8_t mask = 0x80;
-        firstCol     = 0;
-        for (int j = 0; j < 7; j++) {
-          for (int i = firstRow; i <= lastRow; i++) {
-            if (bytes[i] & mask) goto end1;
-          }
-          mask >>= 1;
-          firstCol += 1;
-        }
-end1:
-        mask    = 0x01;
-        lastCol = 7;
-        for (int j = 0; j < 7; j++) {
-          for (int i = firstRow; i <= lastRow; i++) {
-            if (bytes[i] & mask) goto end2;
-          }
-          mask <<= 1;
-          lastCol -= 1;
-        }
-      } else {
-        uint8_t mask = 0x80;
-        firstCol     = 0;
-        for (int j = 0; j < 15; j++) {
-          for (int i = firstRow; i <= lastRow; i++) {
-            if (bytes[(i << 1) + (j >> 3)] & mask) goto end3;
-          }
-          mask >>= 1;
-          if (mask == 0) mask = 0x80;
-          firstCol += 1;
-        }
-end3:
-        mask    = 0x01;
-        lastCol = 15;
-        for (int j = 15; j >= 0; j--) {
-          for (int i = firstRow; i <= lastRow; i++) {
-            if (bytes[(i << 1) + (j >> 3)] & mask) goto end4;
-          }
-          mask <<= 1;
-          if (mask == 0) mask = 0x01;
-          lastCol -= 1;
-        }
-      }
+// Decodes the glyph hex digits of a line into 16 rows. The line must contain
+// 32 (8 pixels wide glyph) or 64 (16 pixels wide glyph) hex digits.
+auto IBMFHexImport::readGlyphRows(const char *ptr, const char *lineEnd, HexGlyph &hexGlyph)
+    -> bool {
+  if ((lineEnd > ptr) && (lineEnd[-1] == '\r')) lineEnd--;
 
-end2:
-end4:
-      bitmap->dim   = Dim(lastCol - firstCol + 1, lastRow - firstRow + 1);
-      vOffset       = 14 - firstRow;
-
-      uint8_t *buff = bytes.data() + (firstRow * byteWidth);
-      for (int row = firstRow; row <= lastRow; row++) {
-        uint8_t mask = 0x80 >> (firstCol & 7);
-        for (int col = firstCol; col <= lastCol; col++) {
-          uint8_t pixel = ((buff[col >> 3] & mask) == 0) ? 0 : 0xFF;
-          bitmap->pixels.push_back(pixel);
-          mask >>= 1;
-          if (mask == 0) mask = 0x80;
-        }
-        buff += byteWidth;
-      }
+  uint32_t value;
+  auto     length = lineEnd - ptr;
 
-    } else {
-      std::cout << "GNU Unifont Read Error!!!" << std::endl;
-      return NO_GLYPH_CODE;
+  if (length == 64) {
+    hexGlyph.wide = true;
+    for (int row = 0; row < 16; row += 2, ptr += 8) {
+      if (!hexToUInt32(ptr, value)) return false;
+      hexGlyph.rows[row]     = value >> 16;
+      hexGlyph.rows[row + 1] = value & 0xFFFF;
     }
-
-    auto posit = positionList.find(codePoint);
-    if ((posit != positionList.end()) && (posit->second == RIGHT)) {
-      hOffset = -(advance - bitmap->dim.width - 1);
-    } else {
-      hOffset = 0;
+  } else if (length == 32) {
+    hexGlyph.wide = false;
+    for (int row = 0; row < 16; row += 4, ptr += 8) {
+      if (!hexToUInt32(ptr, value)) return false;
+      hexGlyph.rows[row]     = (value >> 16) & 0xFF00;
+      hexGlyph.rows[row + 1] = (value >> 8) & 0xFF00;
+      hexGlyph.rows[row + 2] = value & 0xFF00;
+      hexGlyph.rows[row + 3] = (value << 8) & 0xFF00;
     }
-
-    return glyphCode;
   } else {
+    std::cout << "GNU Unifont Read Error!!!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Value of the first four bytes of the glyph, as present in the hex file
+static inline auto firstBytesOf(const IBMFHexImport::HexGlyph &hexGlyph) -> uint32_t {
+  if (hexGlyph.wide) return (hexGlyph.rows[0] << 16) | hexGlyph.rows[1];
+  return ((hexGlyph.rows[0] & 0xFF00) << 16) | ((hexGlyph.rows[1] & 0xFF00) << 8) |
+         (hexGlyph.rows[2] & 0xFF00) | (hexGlyph.rows[3] >> 8);
+}
+
+// Crops the glyph to its bounding box and expands it to 8 bits pixels. The box is
+// obtained from the rows OR-reduction (columns) and the non-empty rows mask.
+auto IBMFHexImport::readOneGlyph(const HexGlyph &hexGlyph, BitmapPtr bitmap, int8_t &hOffset,
+                                 int8_t &vOffset, uint16_t &advance) const -> bool {
 
-noCode:
-    while (!in.eof() && (in.get() != '\n'))
-      ;
-    return NO_GLYPH_CODE;
+  // Expansion of a 4 pixels nibble to 8 bits pixels
+  static constexpr uint32_t expand[16] = {
+      0x00000000, 0xFF000000, 0x00FF0000, 0xFFFF0000, 0x0000FF00, 0xFF00FF00,
+      0x00FFFF00, 0xFFFFFF00, 0x000000FF, 0xFF0000FF, 0x00FF00FF, 0xFFFF00FF,
+      0x0000FFFF, 0xFF00FFFF, 0x00FFFFFF, 0xFFFFFFFF,
+  };
+
+  advance          = hexGlyph.wide ? 16 : 8;
+
+  uint32_t columns = 0;
+  uint32_t rowMask = 0;
+  for (int row = 0; row < 16; row++) {
+    columns |= hexGlyph.rows[row];
+    rowMask |= (hexGlyph.rows[row] != 0) << row;
+  }
 
-spaceCode:
+  if (columns == 0) {
     bitmap->dim = Dim(0, 0);
     bitmap->pixels.clear();
     vOffset = 0;
     hOffset = 0;
-    return SPACE_CODE;
+    return true;
+  }
+
+  int firstRow = __builtin_ctz(rowMask);
+  int lastRow  = 31 - __builtin_clz(rowMask);
+  int firstCol = __builtin_clz(columns) - 16;
+  int lastCol  = 15 - __builtin_ctz(columns);
+  int width    = lastCol - firstCol + 1;
+
+  bitmap->dim  = Dim(width, lastRow - firstRow + 1);
+  vOffset      = 14 - firstRow;
+
+  bitmap->pixels.resize(width * bitmap->dim.height);
+  uint8_t *pixels = bitmap->pixels.data();
+  for (int row = firstRow; row <= lastRow; row++, pixels += width) {
+    uint32_t bits = static_cast<uint16_t>(hexGlyph.rows[row] << firstCol);
+    uint32_t line[4];
+    line[0] = expand[bits >> 12];
+    line[1] = expand[(bits >> 8) & 0x0F];
+    line[2] = expand[(bits >> 4) & 0x0F];
+    line[3] = expand[bits & 0x0F];
+    memcpy(pixels, line, width);
+  }
+
+  auto posit = positionList.find(hexGlyph.codePoint);
+  if ((posit != positionList.end()) && (posit->second == RIGHT)) {
+    hOffset = -(advance - bitmap->dim.width - 1);
+  } else {
+    hOffset = 0;
   }
 
   return true;
 }
 
-// Returns true if the received character is part of the control characters nor
+// Returns true if the received character is not part of the control characters nor
 // one of the space characters as defined in Unicode.
-auto IBMFHexImport::charSelected(char32_t ch, UBlocks &uBlocks, uint32_t firstBytes) const -> bool {
+auto IBMFHexImport::charAllowed(char32_t ch, uint32_t firstBytes) const -> bool {
   // Don't populate with space and non-break-space characters
-  if ((ch >= 0x0021) && (ch != 0x00A0) && ((ch < 0x02000) || (ch > 0x200F)) &&
-      ((ch < 0x02028) || (ch > 0x202F)) && ((ch < 0x0205F) || (ch > 0x206F)) &&
-      (firstBytes != 0xAAAA0001) /* && (firstBytes != 0x00007FFE) */) {
+  return (ch >= 0x0021) && (ch != 0x00A0) && ((ch < 0x02000) || (ch > 0x200F)) &&
+         ((ch < 0x02028) || (ch > 0x202F)) && ((ch < 0x0205F) || (ch > 0x206F)) &&
+         (firstBytes != 0xAAAA0001) /* && (firstBytes != 0x00007FFE) */;
+}
+
+// Returns true if the received character is allowed and part of one of the blocks.
+auto IBMFHexImport::charSelected(char32_t ch, UBlocks &uBlocks, uint32_t firstBytes) const -> bool {
+  if (charAllowed(ch, firstBytes)) {
     for (auto &uBlockDef : uBlocks) {
       if ((ch >= uBlockDef.first_) && (ch <= uBlockDef.last_)) {
         return true;
@@ -226,187 +230,712 @@ auto IBMFHexImport::charSelected(char32_t ch, UBlocks &uBlocks, uint32_t firstBy
   return false;
 }
 
-auto IBMFHexImport::prepareCodePlanes(std::fstream &in, UBlocks &uBlocks) -> int {
+// Returns the blocks sorted by first codePoint, overlapping or adjacent blocks
+// being merged. Required by the sequential selection algorithms.
+auto IBMFHexImport::sortedBlocks(const UBlocks &uBlocks) const -> UBlocks {
+  UBlocks blocks = uBlocks;
+  std::sort(blocks.begin(), blocks.end(),
+            [](const UBlockDef &a, const UBlockDef &b) { return a.first_ < b.first_; });
+
+  UBlocks result;
+  for (auto &uBlockDef : blocks) {
+    if (!result.empty() && (uBlockDef.first_ <= (result.back().last_ + 1))) {
+      result.back().last_ = std::max(result.back().last_, uBlockDef.last_);
+    } else {
+      result.push_back(uBlockDef);
+    }
+  }
+  return result;
+}
+
+// Merge-join of the hex file codePoints with the sorted blocks: as the hex file is
+// sorted, the cursor only moves forward. Out of order codePoints are located through
+// a binary search.
+auto IBMFHexImport::inBlocks(char32_t ch, const UBlocks &blocks, size_t &cursor) const -> bool {
+  if ((cursor > 0) && (cursor <= blocks.size()) && (ch <= blocks[cursor - 1].last_)) {
+    cursor = std::upper_bound(blocks.begin(), blocks.end(), ch,
+                              [](char32_t c, const UBlockDef &b) { return c < b.first_; }) -
+             blocks.begin();
+    if (cursor > 0) cursor -= 1;
+  }
+  while ((cursor < blocks.size()) && (blocks[cursor].last_ < ch)) {
+    cursor += 1;
+  }
+  return (cursor < blocks.size()) && (ch >= blocks[cursor].first_);
+}
+
+auto IBMFHexImport::startFont() -> FacePtr {
 
-  uint16_t glyphCode = 0;
+  clear();
+
+  // ----- Preamble -----
+
+  // clang-format off
+  preamble_ = {
+      .marker    = {'I', 'B', 'M', 'F'},
+      .faceCount = 1,
+      .bits      = {.version = IBMF_VERSION, .fontFormat = FontFormat::UTF32}
+  };
+  // clang-format on
 
   for (int i = 0; i < 4; i++) {
     planes_.push_back(Plane({0, 0, 0}));
   }
+  currPlaneIdx_ = 0;
+
+  return FacePtr(new Face);
+}
+
+// Integrates a codePoint in the planes / bundles tables. CodePoints must be
+// received in increasing order, glyphCode being the index of the glyph in the face.
+auto IBMFHexImport::addToCodePlanes(char32_t codePoint, GlyphCode glyphCode) -> void {
+
+  int      planeIdx = codePoint >> 16;
+  char16_t u16      = static_cast<char16_t>(codePoint & 0x0000FFFF);
+
+  if (codePointBundles_.empty() || (planeIdx != currPlaneIdx_)) {
+    // Completes the info of planes skipped
+    for (int idx = codePointBundles_.empty() ? 0 : currPlaneIdx_ + 1; idx < planeIdx; idx++) {
+      planes_[idx] = Plane{.codePointBundlesIdx = static_cast<uint16_t>(codePointBundles_.size()),
+                           .entriesCount        = 0,
+                           .firstGlyphCode      = glyphCode};
+    }
+    planes_[planeIdx] = Plane{.codePointBundlesIdx = static_cast<uint16_t>(codePointBundles_.size()),
+                              .entriesCount        = 1,
+                              .firstGlyphCode      = glyphCode};
+    codePointBundles_.push_back(CodePointBundle({.firstCodePoint = u16, .lastCodePoint = u16}));
+    currPlaneIdx_ = planeIdx;
+  } else if (u16 == (codePointBundles_.back().lastCodePoint + 1)) {
+    codePointBundles_.back().lastCodePoint = u16;
+  } else {
+    codePointBundles_.push_back(CodePointBundle({.firstCodePoint = u16, .lastCodePoint = u16}));
+    planes_[planeIdx].entriesCount += 1;
+  }
+}
+
+// Crops a selected glyph. Doesn't modify the font such that it can be
+// called from parallel workers.
+auto IBMFHexImport::cropGlyph(const HexGlyph &hexGlyph, CroppedGlyph &glyph) const -> bool {
+
+  if ((hexGlyph.codePoint >> 16) >= 4) return false; // Only the first 4 planes are managed
+
+  glyph.codePoint = hexGlyph.codePoint;
+  glyph.bitmap    = BitmapPtr(new Bitmap());
+
+  return readOneGlyph(hexGlyph, glyph.bitmap, glyph.hOffset, glyph.vOffset, glyph.advance);
+}
+
+auto IBMFHexImport::addGlyph(FacePtr &face, const HexGlyph &hexGlyph) -> bool {
+  CroppedGlyph glyph;
+
+  if (!cropGlyph(hexGlyph, glyph)) return false;
+
+  appendGlyph(face, glyph);
+
+  return true;
+}
+
+// Metrics of a cropped glyph. The RLE related fields, ligKernPgmIndex and
+// mainCode are left to be set by the caller.
+auto IBMFHexImport::glyphInfoFor(const CroppedGlyph &glyph) const -> GlyphInfo {
+
+  char32_t  codePoint = glyph.codePoint;
+  BitmapPtr bitmap    = glyph.bitmap;
+
+  return GlyphInfo{
+      .bitmapWidth      = static_cast<uint8_t>(bitmap->dim.width),
+      .bitmapHeight     = static_cast<uint8_t>(bitmap->dim.height),
+      .horizontalOffset = static_cast<int8_t>(glyph.hOffset),
+      .verticalOffset   = static_cast<int8_t>(glyph.vOffset),
+      .packetLength     = static_cast<uint16_t>(bitmap->dim.width * bitmap->dim.height),
+      .advance          = static_cast<FIX16>(
+          ((codePoint < 0x2E80) || ((codePoint >= 0xA000) && (codePoint < 0xFE10)) ||
+                   ((codePoint >= 0xFE70) && (codePoint < 0xFF00))
+                        ? (bitmap->dim.width + 1)
+                        : glyph.advance)
+          << 6),
+      .rleMetrics      = RLEMetrics{.dynF               = 0,
+                                    .firstIsBlack       = false,
+                                    .beforeAddedOptKern = 0,
+                                    .afterAddedOptKern  = 0},
+      .ligKernPgmIndex = 0, // completed at save time
+      .mainCode        = 0
+  };
+}
+
+// Adds a glyph at the end of the face. The glyphs must be received in
+// increasing codePoint order.
+auto IBMFHexImport::appendGlyph(FacePtr &face, const CroppedGlyph &glyph) -> void {
+
+  GlyphCode glyphCode = static_cast<GlyphCode>(face->glyphs.size());
+
+  addToCodePlanes(glyph.codePoint, glyphCode);
+
+  face->bitmaps.append(*glyph.bitmap);
+
+  // Ligatures are computed once all glyphs are known (see completeFont())
+  face->ligSteps.append(nullptr, 0);
+  face->kernSteps.append(nullptr, 0);
+
+  // ----- Glyph Info -----
+
+  GlyphInfo glyphInfo = glyphInfoFor(glyph);
+  glyphInfo.mainCode  = (glyph.bitmap->dim.width == 0) ? SPACE_CODE // Blank glyph
+                                                       : glyphCode; // No composite management (for now)
+
+  face->glyphs.push_back(glyphInfo);
+}
 
-  bool     firstSelected          = false;
-  char16_t currCodePoint          = 0;
-  int      currPlaneIdx           = 0;
-  int      currCodePointBundleIdx = 0;
-  char32_t codePoint;
+auto IBMFHexImport::completeFont(FacePtr &face) -> bool {
+
+  GlyphCode glyphCount = static_cast<GlyphCode>(face->glyphs.size());
+
+  if (glyphCount == 0) return false;
+
+  // Completes the info of planes not used
+  for (int idx = currPlaneIdx_ + 1; idx < 4; idx++) {
+    planes_[idx].codePointBundlesIdx = codePointBundles_.size();
+    planes_[idx].firstGlyphCode      = glyphCount;
+  }
+  buildGlyphCodeIndex();
+
+  // ----- Face Header -----
+
+  face->header = FaceHeaderPtr(new FaceHeader({
+      .pointSize        = 10,
+      .lineHeight       = static_cast<uint8_t>(16),
+      .dpi              = static_cast<uint16_t>(75),
+      .xHeight          = static_cast<FIX16>(8 << 6),
+      .emSize           = static_cast<FIX16>(10 << 6),
+      .slantCorrection  = 0, // not available for FreeType
+      .descenderHeight  = static_cast<uint8_t>(2),
+      .spaceSize        = 5,
+      .glyphCount       = glyphCount,
+      .ligKernStepCount = 0, // will be set at save time
+      .pixelsPoolSize   = 0, // will be set at save time
+  }));
+  faces_.push_back(face);
+
+  // Create ligatures for the glyphs if available. Both next and replacement
+  // glyph codes must be present in the resulting IBMF font
+  recomputeLigatures();
+
+  return true;
+}
+
+// Retrieves and crops the selected glyphs of a part of the hex file. The part
+// must start at the beginning of a line.
+auto IBMFHexImport::readChunk(const char *ptr, const char *end, const UBlocks &blocks,
+                              CroppedGlyphs &glyphs) const -> void {
+  size_t cursor = 0;
+
+  while (ptr < end) {
+    const char *lineEnd = static_cast<const char *>(memchr(ptr, '\n', end - ptr));
+    if (lineEnd == nullptr) lineEnd = end;
+
+    HexGlyph     hexGlyph;
+    uint32_t     firstBytes;
+    CroppedGlyph glyph;
+
+    if (readCodePoint(ptr, lineEnd, hexGlyph.codePoint, firstBytes) &&
+        inBlocks(hexGlyph.codePoint, blocks, cursor) &&
+        charAllowed(hexGlyph.codePoint, firstBytes) && readGlyphRows(ptr, lineEnd, hexGlyph) &&
+        cropGlyph(hexGlyph, glyph)) {
+      glyphs.push_back(glyph);
+    }
+
+    ptr = lineEnd + 1;
+  }
+}
+
+// Splits a part of the hex file made of complete lines in chunks of about the
+// same size, cut at line boundaries. Returns the chunkCount + 1 chunk limits.
+static auto splitLines(const char *begin, const char *end, int chunkCount)
+    -> std::vector<const char *> {
+  std::vector<const char *> limits;
+  limits.push_back(begin);
+  for (int i = 1; i < chunkCount; i++) {
+    const char *ptr = std::max(begin + ((end - begin) / chunkCount) * i, limits.back());
+    const char *eol = static_cast<const char *>(memchr(ptr, '\n', end - ptr));
+    limits.push_back((eol == nullptr) ? end : eol + 1);
+  }
+  limits.push_back(end);
+  return limits;
+}
+
+// Retrieves, crops and appends to the face the selected glyphs of a part of the
+// hex file made of complete lines.
+//
+// With more than one thread (see setThreadCount()), the part is split at line
+// boundaries in chunks that are parsed, filtered and cropped by a pool of
+// workers. The chunks are then merged in file order, giving the same result
+// as the single threaded pass.
+auto IBMFHexImport::readLines(const char *begin, const char *end, const UBlocks &blocks,
+                              FacePtr &face) -> void {
+
+  int threadCount = threadCountFor(threadCount_);
+  int chunkCount  = (threadCount == 1) ? 1 : (threadCount * 4);
+
+  std::vector<const char *>  limits = splitLines(begin, end, chunkCount);
+  std::vector<CroppedGlyphs> chunks(chunkCount);
+
+  parallelFor(chunkCount, threadCount, [&](size_t idx) {
+    readChunk(limits[idx], limits[idx + 1], blocks, chunks[idx]);
+  });
+
+  for (auto &chunk : chunks) {
+    for (auto &glyph : chunk) {
+      appendGlyph(face, glyph);
+    }
+    chunk.clear();
+  }
+}
+
+// Inflates a gzip compressed hex file and feeds its lines to the linesReader,
+// one buffer at a time: the decompressed file is never present in memory as a
+// whole (see GzLineReader).
+auto IBMFHexImport::readGzLines(const MappedFile &gzFile, const LinesReader &linesReader) -> bool {
+
+  GzLineReader reader;
+
+  if (!reader.open(gzFile.data(), gzFile.size())) return false;
+
+  const char *begin, *end;
+  while (reader.nextLines(begin, end)) {
+    linesReader(begin, end);
+  }
+
+  return !reader.failed();
+}
+
+// The hex file is memory mapped and read in a single pass: the planes, the
+// codePoint bundles and the glyphs are built as the selected lines are
+// encountered. A gzip compressed hex file (.gz suffix) is inflated on the fly.
+auto IBMFHexImport::loadHex(std::string filename, UBlocks &uBlocks) -> bool {
+
+  MappedFile hexFile;
+
+  if (!hexFile.open(filename)) return false;
+
+  FacePtr face   = startFont();
+
+  UBlocks blocks = sortedBlocks(uBlocks);
+
+  if (HasSuffix(filename, ".gz")) {
+    auto linesReader = [&](const char *begin, const char *end) {
+      readLines(begin, end, blocks, face);
+    };
+    if (!readGzLines(hexFile, linesReader)) return false;
+  } else {
+    readLines(hexFile.begin(), hexFile.end(), blocks, face);
+  }
+
+  hexFile.close();
+
+  return completeFont(face);
+}
+
+// Decodes all the glyphs of a part of the hex file. The part must start at the
+// beginning of a line.
+auto IBMFHexImport::parseChunk(const char *ptr, const char *end, HexGlyphs &glyphs) const -> void {
+  while (ptr < end) {
+    const char *lineEnd = static_cast<const char *>(memchr(ptr, '\n', end - ptr));
+    if (lineEnd == nullptr) lineEnd = end;
+
+    HexGlyph hexGlyph;
+    uint32_t firstBytes;
+
+    if (readCodePoint(ptr, lineEnd, hexGlyph.codePoint, firstBytes) &&
+        ((hexGlyph.codePoint >> 16) < 4) && readGlyphRows(ptr, lineEnd, hexGlyph)) {
+      glyphs.push_back(hexGlyph);
+    }
+
+    ptr = lineEnd + 1;
+  }
+}
+
+// Same chunking as readLines(), the decoded glyphs being appended to parsedGlyphs_.
+auto IBMFHexImport::parseLines(const char *begin, const char *end) -> void {
+
+  int threadCount = threadCountFor(threadCount_);
+  int chunkCount  = (threadCount == 1) ? 1 : (threadCount * 4);
+
+  std::vector<const char *> limits = splitLines(begin, end, chunkCount);
+  std::vector<HexGlyphs>    chunks(chunkCount);
+
+  parallelFor(chunkCount, threadCount, [&](size_t idx) {
+    parseChunk(limits[idx], limits[idx + 1], chunks[idx]);
+  });
+
+  for (auto &chunk : chunks) {
+    parsedGlyphs_.insert(parsedGlyphs_.end(), chunk.begin(), chunk.end());
+  }
+}
+
+auto IBMFHexImport::parseHex(std::string filename) -> bool {
+
+  MappedFile hexFile;
+
+  parsedGlyphs_.clear();
+
+  if (!hexFile.open(filename)) return false;
+
+  if (HasSuffix(filename, ".gz")) {
+    auto linesReader = [&](const char *begin, const char *end) { parseLines(begin, end); };
+    if (!readGzLines(hexFile, linesReader)) return false;
+  } else {
+    parseLines(hexFile.begin(), hexFile.end());
+  }
+
+  hexFile.close();
+
+  // GNU Unifont files are sorted. The stable sort keeps duplicates in file order
+  auto byCodePoint = [](const HexGlyph &a, const HexGlyph &b) { return a.codePoint < b.codePoint; };
+  if (!std::is_sorted(parsedGlyphs_.begin(), parsedGlyphs_.end(), byCodePoint)) {
+    std::stable_sort(parsedGlyphs_.begin(), parsedGlyphs_.end(), byCodePoint);
+  }
+
+  return true;
+}
+
+auto IBMFHexImport::selectHex(UBlocks &uBlocks) -> bool {
+
+  FacePtr face   = startFont();
+
+  UBlocks blocks = sortedBlocks(uBlocks);
+
+  for (auto &uBlockDef : blocks) {
+    auto it = std::lower_bound(
+        parsedGlyphs_.begin(), parsedGlyphs_.end(), uBlockDef.first_,
+        [](const HexGlyph &glyph, char32_t codePoint) { return glyph.codePoint < codePoint; });
+    for (; (it != parsedGlyphs_.end()) && (it->codePoint <= uBlockDef.last_); it++) {
+      if (charAllowed(it->codePoint, firstBytesOf(*it))) {
+        addGlyph(face, *it);
+      }
+    }
+  }
+
+  return completeFont(face);
+}
+
+// Sequential reader of the glyphs of a hex source, used by mergeHex(). Lines
+// that are not in increasing codePoint order are skipped.
+class IBMFHexImport::HexSource {
+private:
+  static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+  std::string  filename_;
+  MappedFile   file_;
+  GzLineReader gzReader_;
+  bool         compressed_{false};
+  bool         failed_{false};
+  const char  *ptr_{nullptr};
+  const char  *end_{nullptr};
+
+public:
+  HexGlyph glyph;
   uint32_t firstBytes;
+  bool     valid{false}; // True if glyph and firstBytes are set
+
+  auto open(const std::string &filename) -> bool {
+    filename_ = filename;
+    if (!file_.open(filename)) return false;
+    compressed_ = HasSuffix(filename, ".gz");
+    if (compressed_) {
+      if (!gzReader_.open(file_.data(), file_.size(), BUFFER_SIZE)) return false;
+    } else {
+      ptr_ = file_.begin();
+      end_ = file_.end();
+    }
+    return true;
+  }
 
-  while (readCodePoint(in, codePoint, firstBytes)) {
-    if (charSelected(codePoint, uBlocks, firstBytes)) {
-      int planeIdx = codePoint >> 16;
-      if (planeIdx < 4) { // Only the first 4 planes are managed
-        char16_t u16 = static_cast<char16_t>(codePoint & 0x0000FFFF);
-        if (!firstSelected) {
-          currCodePoint     = u16;
-          currPlaneIdx      = planeIdx;
-          planes_[planeIdx] = Plane{
-              .codePointBundlesIdx = static_cast<uint16_t>(codePointBundles_.size()),
-              .entriesCount        = 1,
-              .firstGlyphCode      = 0,
-          };
-          currCodePointBundleIdx = codePointBundles_.size();
-          CodePointBundle bundle = CodePointBundle({.firstCodePoint = u16, .lastCodePoint = u16});
-          codePointBundles_.push_back(bundle);
-          firstSelected = true;
-        } else {
-          if (planeIdx != currPlaneIdx) {
-            for (int idx = planeIdx + 1; idx <= currPlaneIdx; idx++) {
-              planes_[idx].codePointBundlesIdx = codePointBundles_.size();
-            }
-            planes_[planeIdx] =
-                Plane{.codePointBundlesIdx = static_cast<uint16_t>(codePointBundles_.size()),
-                      .entriesCount        = 1,
-                      .firstGlyphCode      = glyphCode};
-            currCodePointBundleIdx = codePointBundles_.size();
-            CodePointBundle bundle = CodePointBundle({.firstCodePoint = u16, .lastCodePoint = u16});
-            codePointBundles_.push_back(bundle);
-            currCodePoint = u16;
-            currPlaneIdx  = planeIdx;
-          } else {
-            if (u16 == (currCodePoint + 1)) {
-              codePointBundles_[currCodePointBundleIdx].lastCodePoint = u16;
-            } else {
-              currCodePointBundleIdx = codePointBundles_.size();
-              CodePointBundle bundle =
-                  CodePointBundle({.firstCodePoint = u16, .lastCodePoint = u16});
-              codePointBundles_.push_back(bundle);
-              planes_[currPlaneIdx].entriesCount += 1;
-            }
-            currCodePoint = u16;
-          }
+  auto failed() const -> bool { return failed_ || gzReader_.failed(); }
+
+  // Retrieves the next glyph of the source. Returns false at the end of the source.
+  auto next() -> bool {
+    bool     hadGlyph = valid;
+    char32_t previous = glyph.codePoint;
+
+    valid             = false;
+    while (true) {
+      if (ptr_ >= end_) {
+        if (!compressed_ || !gzReader_.nextLines(ptr_, end_)) return false;
+      }
+
+      const char *lineEnd = static_cast<const char *>(memchr(ptr_, '\n', end_ - ptr_));
+      if (lineEnd == nullptr) lineEnd = end_;
+
+      const char *ptr = ptr_;
+      ptr_            = lineEnd + 1;
+
+      if (readCodePoint(ptr, lineEnd, glyph.codePoint, firstBytes) &&
+          ((glyph.codePoint >> 16) < 4) && readGlyphRows(ptr, lineEnd, glyph)) {
+        if (hadGlyph && (glyph.codePoint <= previous)) {
+          log_w("%s: U+%X out of order, ignored.", filename_.c_str(), (unsigned)glyph.codePoint);
+          glyph.codePoint = previous;
+          continue;
         }
+        valid = true;
+        return true;
       }
-      glyphCode += 1;
     }
   }
-  // Completes the info of planes not used
-  for (int idx = currPlaneIdx + 1; idx < 4; idx++) {
-    planes_[idx].codePointBundlesIdx = codePointBundles_.size();
-    planes_[idx].firstGlyphCode      = glyphCode;
+};
+
+// K-way merge of the hex sources by codePoint. The glyphReader receives the
+// glyphs in increasing codePoint order, the last source having priority. Only
+// one line per source (and the decompression buffer of gzip compressed
+// sources) is in memory at any time.
+auto IBMFHexImport::mergeHex(const std::vector<std::string> &filenames,
+                             const GlyphReader &glyphReader) -> bool {
+
+  std::vector<std::unique_ptr<HexSource>> sources;
+
+  for (auto &filename : filenames) {
+    sources.emplace_back(new HexSource);
+    if (!sources.back()->open(filename)) return false;
+    sources.back()->next();
   }
 
-  return glyphCode;
+  while (true) {
+    HexSource *selected = nullptr;
+    for (auto &source : sources) {
+      if (source->valid &&
+          ((selected == nullptr) || (source->glyph.codePoint <= selected->glyph.codePoint))) {
+        selected = source.get();
+      }
+    }
+    if (selected == nullptr) break;
+
+    char32_t codePoint = selected->glyph.codePoint;
+    glyphReader(selected->glyph, selected->firstBytes);
+
+    for (auto &source : sources) {
+      if (source->valid && (source->glyph.codePoint == codePoint)) {
+        source->next();
+      }
+    }
+  }
+
+  for (auto &source : sources) {
+    if (source->failed()) return false;
+  }
+  return true;
 }
 
-auto IBMFHexImport::loadHex(std::string filename, UBlocks &uBlocs) -> bool {
+auto IBMFHexImport::loadHexSources(const std::vector<std::string> &filenames, UBlocks &uBlocks)
+    -> bool {
 
-  clear();
+  FacePtr face   = startFont();
 
-  // ----- Preamble -----
+  UBlocks blocks = sortedBlocks(uBlocks);
+  size_t  cursor = 0;
 
-  // clang-format off
-  preamble_ = {
-      .marker    = {'I', 'B', 'M', 'F'},
-      .faceCount = 1,
-      .bits      = {.version = IBMF_VERSION, .fontFormat = FontFormat::UTF32}
+  auto glyphReader = [&](const HexGlyph &hexGlyph, uint32_t firstBytes) {
+    if (inBlocks(hexGlyph.codePoint, blocks, cursor) &&
+        charAllowed(hexGlyph.codePoint, firstBytes)) {
+      addGlyph(face, hexGlyph);
+    }
   };
-  // clang-format on
 
-  std::fstream in;
-  in.open(filename, std::ios::in);
+  if (!mergeHex(filenames, glyphReader)) return false;
+
+  return completeFont(face);
+}
+
+auto IBMFHexImport::parseHexSources(const std::vector<std::string> &filenames) -> bool {
+
+  if (filenames.size() == 1) return parseHex(filenames[0]);
+
+  parsedGlyphs_.clear();
+
+  auto glyphReader = [&](const HexGlyph &hexGlyph, uint32_t firstBytes) {
+    parsedGlyphs_.push_back(hexGlyph);
+  };
+
+  return mergeHex(filenames, glyphReader);
+}
+
+// Builds a glyph store from a hex file. This is to be done once for a Unifont
+// release; loadStore() can then be used in place of loadHex().
+auto IBMFHexImport::compileHex(std::string hexFilename, std::string storeFilename) -> bool {
+
+  MappedFile hexFile;
 
-  if (in.is_open()) {
+  if (!hexFile.open(hexFilename)) return false;
 
-    int glyphCount = prepareCodePlanes(in, uBlocs);
+  UnifontStore store;
+  int          count = 0;
 
-    if (glyphCount <= 0) {
-      in.close();
-      return false;
+  const char *ptr    = hexFile.begin();
+  const char *end    = hexFile.end();
+
+  while (ptr < end) {
+    const char *lineEnd = static_cast<const char *>(memchr(ptr, '\n', end - ptr));
+    if (lineEnd == nullptr) lineEnd = end;
+
+    HexGlyph hexGlyph;
+    uint32_t firstBytes;
+
+    if (readCodePoint(ptr, lineEnd, hexGlyph.codePoint, firstBytes) &&
+        readGlyphRows(ptr, lineEnd, hexGlyph)) {
+      UnifontStore::Glyph glyph;
+      memcpy(glyph.rows, hexGlyph.rows, sizeof(glyph.rows));
+      if (store.addGlyph(hexGlyph.codePoint, glyph, hexGlyph.wide)) {
+        count += 1;
+      } else {
+        std::cout << "Glyph U+" << std::hex << +hexGlyph.codePoint << std::dec
+                  << " not retained in the glyph store." << std::endl;
+      }
     }
 
-    FacePtr face = FacePtr(new Face);
-
-    in.close();
-    in.open(filename, std::ios::in);
-
-    while (!in.eof()) {
-      char32_t  codePoint;
-      auto      bitmap = BitmapPtr(new Bitmap());
-      int8_t    hOffset, vOffset;
-      GlyphCode glyphCode;
-      uint16_t  advance;
-
-      if ((glyphCode = readOneGlyph(in, codePoint, bitmap, hOffset, vOffset, advance)) !=
-          NO_GLYPH_CODE) {
-
-        face->bitmaps.push_back(bitmap);
-
-        GlyphLigKernPtr glyphLigKern = GlyphLigKernPtr(new GlyphLigKern);
-
-        // Create ligatures for the glyph if available
-        // Ensure that both next and replacement glyph codes are present in the
-        // resulting IBMF font
-        char32_t firstChar = getUTF32(glyphCode);
-        for (auto &ligature : ligatures) {
-          if (ligature.firstChar == firstChar) {
-            GlyphCode nextGlyphCode        = toGlyphCode(ligature.nextChar);
-            GlyphCode replacementGlyphCode = toGlyphCode(ligature.replacement);
-            if ((nextGlyphCode != NO_GLYPH_CODE) && (replacementGlyphCode != NO_GLYPH_CODE)) {
-              glyphLigKern->ligSteps.push_back(GlyphLigStep{
-                  .nextGlyphCode = nextGlyphCode, .replacementGlyphCode = replacementGlyphCode});
-            }
-          }
+    ptr = lineEnd + 1;
+  }
+
+  hexFile.close();
+
+  std::cout << "Glyph store " << storeFilename << ": " << count << " glyphs." << std::endl;
+
+  return store.save(storeFilename);
+}
+
+// Builds the font from a pre-compiled glyph store. Only the codePoints part of
+// the blocks are looked at.
+auto IBMFHexImport::loadStore(std::string filename, UBlocks &uBlocks) -> bool {
+
+  UnifontStore store;
+
+  if (!store.open(filename)) return false;
+
+  FacePtr face = startFont();
+
+  // The glyphs must be added in codePoint order
+  UBlocks blocks = sortedBlocks(uBlocks);
+
+  for (auto &uBlockDef : blocks) {
+    for (char32_t codePoint = uBlockDef.first_; codePoint <= uBlockDef.last_; codePoint++) {
+      const UnifontStore::Glyph *glyph;
+      bool                       wide;
+      if (store.getGlyph(codePoint, glyph, wide)) {
+        HexGlyph hexGlyph;
+        hexGlyph.codePoint = codePoint;
+        hexGlyph.wide      = wide;
+        memcpy(hexGlyph.rows, glyph->rows, sizeof(hexGlyph.rows));
+        if (charAllowed(codePoint, firstBytesOf(hexGlyph))) {
+          addGlyph(face, hexGlyph);
         }
+      }
+    }
+  }
+
+  store.close();
+
+  return completeFont(face);
+}
+
+// Builds a glyph pack from a hex file: every allowed glyph is cropped and RLE
+// encoded once, as save() would do it. This is to be done once for a Unifont
+// release; loadPack() can then be used in place of loadHex().
+auto IBMFHexImport::compilePack(std::string hexFilename, std::string packFilename) -> bool {
+
+  MappedFile hexFile;
+
+  if (!hexFile.open(hexFilename)) return false;
+
+  UBlocks       blocks = {UBlockDef(0, 0x3FFFF, "All planes")};
+  CroppedGlyphs glyphs;
+
+  readChunk(hexFile.begin(), hexFile.end(), blocks, glyphs);
 
-        face->glyphsLigKern.push_back(glyphLigKern);
-
-        // ----- Glyph Info -----
-
-        GlyphInfoPtr glyphInfo = GlyphInfoPtr(new GlyphInfo(GlyphInfo{
-            .bitmapWidth      = static_cast<uint8_t>(bitmap->dim.width),
-            .bitmapHeight     = static_cast<uint8_t>(bitmap->dim.height),
-            .horizontalOffset = static_cast<int8_t>(hOffset),
-            .verticalOffset   = static_cast<int8_t>(vOffset),
-            .packetLength     = static_cast<uint16_t>(bitmap->dim.width * bitmap->dim.height),
-            .advance          = static_cast<FIX16>(
-                ((codePoint < 0x2E80) || ((codePoint >= 0xA000) && (codePoint < 0xFE10)) ||
-                         ((codePoint >= 0xFE70) && (codePoint < 0xFF00))
-                              ? (bitmap->dim.width + 1)
-                              : advance)
-                << 6),
-            .rleMetrics      = RLEMetrics{.dynF               = 0,
-                                          .firstIsBlack       = false,
-                                          .beforeAddedOptKern = 0,
-                                          .afterAddedOptKern  = 0},
-            .ligKernPgmIndex = 0, // completed at save time
-            .mainCode        = glyphCode  // No composite management (for now)
-        }));
-
-        face->glyphs.push_back(glyphInfo);
+  hexFile.close();
+
+  struct Encoded {
+    GlyphInfo            info;
+    std::vector<uint8_t> data;
+    bool                 ok;
+  };
+  std::vector<Encoded> encoded(glyphs.size());
+
+  parallelFor(glyphs.size(), threadCountFor(threadCount_), [&](size_t idx) {
+    Encoded &enc = encoded[idx];
+    enc.info     = glyphInfoFor(glyphs[idx]);
+    enc.ok       = true;
+    if (glyphs[idx].bitmap->dim.width == 0) {
+      enc.info.rleMetrics.dynF         = 14;
+      enc.info.rleMetrics.firstIsBlack = false;
+      enc.info.packetLength            = 0;
+    } else {
+      RLEGenerator gen;
+      if (gen.encodeBitmap(glyphs[idx].bitmap)) {
+        enc.info.rleMetrics.dynF         = gen.getDynF();
+        enc.info.rleMetrics.firstIsBlack = gen.getFirstIsBlack();
+        enc.data                         = *gen.getData();
+        enc.info.packetLength            = enc.data.size();
+      } else {
+        enc.ok = false;
       }
     }
+  });
 
-    in.close();
-
-    // ----- Face Header -----
-
-    face->header = FaceHeaderPtr(new FaceHeader({
-        .pointSize        = 10,
-        .lineHeight       = static_cast<uint8_t>(16),
-        .dpi              = static_cast<uint16_t>(75),
-        .xHeight          = static_cast<FIX16>(8 << 6),
-        .emSize           = static_cast<FIX16>(10 << 6),
-        .slantCorrection  = 0, // not available for FreeType
-        .descenderHeight  = static_cast<uint8_t>(2),
-        .spaceSize        = 5,
-        .glyphCount       = static_cast<uint16_t>(glyphCount),
-        .ligKernStepCount = 0, // will be set at save time
-        .pixelsPoolSize   = 0, // will be set at save time
-    }));
-    faces_.push_back(std::move(face));
+  GlyphPack pack;
+  int       count = 0;
 
-    return true;
+  for (size_t idx = 0; idx < glyphs.size(); idx++) {
+    if (encoded[idx].ok &&
+        pack.addRecord(glyphs[idx].codePoint, encoded[idx].info, encoded[idx].data.data())) {
+      count += 1;
+    } else {
+      std::cout << "Glyph U+" << std::hex << +glyphs[idx].codePoint << std::dec
+                << " not retained in the glyph pack." << std::endl;
+    }
   }
 
-  return false;
+  std::cout << "Glyph pack " << packFilename << ": " << count << " glyphs." << std::endl;
+
+  return pack.save(packFilename);
+}
+
+// Builds the font from a pre-encoded glyph pack. The selection rules were
+// applied when the pack was built: the records of the codePoints part of the
+// blocks are simply appended, their RLE bitmaps being kept as is up to save().
+auto IBMFHexImport::loadPack(std::string filename, UBlocks &uBlocks) -> bool {
+
+  GlyphPack pack;
+
+  if (!pack.open(filename)) return false;
+
+  FacePtr face = startFont();
+
+  // The glyphs must be added in codePoint order
+  UBlocks blocks = sortedBlocks(uBlocks);
+
+  for (auto &uBlockDef : blocks) {
+    for (char32_t codePoint = uBlockDef.first_; codePoint <= uBlockDef.last_; codePoint++) {
+      const GlyphPack::Record *record;
+      const uint8_t           *rle;
+      if (!pack.getRecord(codePoint, record, rle)) continue;
+
+      GlyphCode glyphCode = static_cast<GlyphCode>(face->glyphs.size());
+
+      addToCodePlanes(codePoint, glyphCode);
+
+      GlyphInfo glyphInfo       = record->info;
+      glyphInfo.ligKernPgmIndex = 0;
+      glyphInfo.mainCode        = (glyphInfo.bitmapWidth == 0) ? SPACE_CODE : glyphCode;
+      face->glyphs.push_back(glyphInfo);
+
+      face->bitmaps.append(Dim(glyphInfo.bitmapWidth, glyphInfo.bitmapHeight));
+      face->compressedBitmaps.append(rle, glyphInfo.packetLength);
+
+      face->ligSteps.append(nullptr, 0);
+      face->kernSteps.append(nullptr, 0);
+    }
+  }
+
+  pack.close();
+
+  preEncoded_ = true;
+
+  return completeFont(face);
 }
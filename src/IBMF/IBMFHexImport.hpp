@@ -1,22 +1,96 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 
+#include "../Misc/MappedFile.hpp"
+#include "GlyphPack.hpp"
 #include "IBMFFontMod.hpp"
+#include "UnifontStore.hpp"
 
 class IBMFHexImport : public IBMFFontMod {
 public:
   IBMFHexImport() : IBMFFontMod() {}
 
-  auto charSelected(char32_t ch, UBlocks &uBlocks, uint32_t firstBytes) const
-      -> bool;
-  auto prepareCodePlanes(std::fstream &in, UBlocks &uBlocks) -> int;
-  auto readCodePoint(std::fstream &in, char32_t &codePoint,
-                     uint32_t &firstBytes) -> bool;
-  auto readOneGlyph(std::fstream &in, char32_t &codePoint, BitmapPtr bitmap,
-                    int8_t &hOffset, int8_t &vOffset, uint16_t &advance) -> GlyphCode;
+  // One line of the GNU Unifont hex file, once decoded. Rows are left aligned
+  // (bit 15 is the leftmost pixel, 8 pixels wide glyphs only use bits 15..8).
+  struct HexGlyph {
+    char32_t codePoint;
+    uint16_t rows[16];
+    bool     wide;
+  };
+
+  auto charSelected(char32_t ch, UBlocks &uBlocks, uint32_t firstBytes) const -> bool;
+  static auto readGlyphRows(const char *ptr, const char *lineEnd, HexGlyph &hexGlyph) -> bool;
+  auto readOneGlyph(const HexGlyph &hexGlyph, BitmapPtr bitmap, int8_t &hOffset, int8_t &vOffset,
+                    uint16_t &advance) const -> bool;
   auto loadHex(std::string filename, UBlocks &uBlocks) -> bool;
+
+  // Two steps import of a hex file. parseHex() decodes all the glyphs of the file
+  // without modifying the font, such that it can be run in a background thread
+  // while the blocks are being computed. selectHex() then builds the font from
+  // the parsed glyphs part of the blocks.
+  auto parseHex(std::string filename) -> bool;
+  auto selectHex(UBlocks &uBlocks) -> bool;
+
+  // Multiple hex sources (plain or gzip compressed), each sorted by codePoint, are
+  // merged in a single streaming pass. When a codePoint is present in more than
+  // one source, the glyph of the last source in the list is retained (e.g. main
+  // Unifont file, then unifont_upper, then local overrides).
+  auto loadHexSources(const std::vector<std::string> &filenames, UBlocks &uBlocks) -> bool;
+  auto parseHexSources(const std::vector<std::string> &filenames) -> bool;
+
+  // Pre-compiled glyph store (see UnifontStore.hpp)
+  auto compileHex(std::string hexFilename, std::string storeFilename) -> bool;
+  auto loadStore(std::string filename, UBlocks &uBlocks) -> bool;
+
+  // Pre-encoded glyph pack (see GlyphPack.hpp)
+  auto compilePack(std::string hexFilename, std::string packFilename) -> bool;
+  auto loadPack(std::string filename, UBlocks &uBlocks) -> bool;
+
+private:
+  int currPlaneIdx_;
+
+  struct CroppedGlyph {
+    char32_t  codePoint;
+    BitmapPtr bitmap;
+    int8_t    hOffset;
+    int8_t    vOffset;
+    uint16_t  advance;
+  };
+  typedef std::vector<CroppedGlyph> CroppedGlyphs;
+
+  typedef std::vector<HexGlyph> HexGlyphs;
+  HexGlyphs parsedGlyphs_; // Result of parseHex(), in codePoint order
+
+  static auto readCodePoint(const char *&ptr, const char *lineEnd, char32_t &codePoint,
+                            uint32_t &firstBytes) -> bool;
+  auto charAllowed(char32_t ch, uint32_t firstBytes) const -> bool;
+  auto sortedBlocks(const UBlocks &uBlocks) const -> UBlocks;
+  auto inBlocks(char32_t ch, const UBlocks &blocks, size_t &cursor) const -> bool;
+
+  auto startFont() -> FacePtr;
+  auto addToCodePlanes(char32_t codePoint, GlyphCode glyphCode) -> void;
+  auto cropGlyph(const HexGlyph &hexGlyph, CroppedGlyph &glyph) const -> bool;
+  auto addGlyph(FacePtr &face, const HexGlyph &hexGlyph) -> bool;
+  auto glyphInfoFor(const CroppedGlyph &glyph) const -> GlyphInfo;
+  auto appendGlyph(FacePtr &face, const CroppedGlyph &glyph) -> void;
+  auto readChunk(const char *ptr, const char *end, const UBlocks &blocks,
+                 CroppedGlyphs &glyphs) const -> void;
+  auto readLines(const char *begin, const char *end, const UBlocks &blocks, FacePtr &face)
+      -> void;
+  auto parseChunk(const char *ptr, const char *end, HexGlyphs &glyphs) const -> void;
+  auto parseLines(const char *begin, const char *end) -> void;
+
+  typedef std::function<void(const char *begin, const char *end)> LinesReader;
+  auto readGzLines(const MappedFile &gzFile, const LinesReader &linesReader) -> bool;
+
+  class HexSource;
+  typedef std::function<void(const HexGlyph &hexGlyph, uint32_t firstBytes)> GlyphReader;
+  auto mergeHex(const std::vector<std::string> &filenames, const GlyphReader &glyphReader)
+      -> bool;
+  auto completeFont(FacePtr &face) -> bool;
 };
 
 typedef std::shared_ptr<IBMFHexImport> IBMFHexImportPtr;
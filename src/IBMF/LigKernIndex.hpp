@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+
+#include "GlyphArena.hpp"
+#include "IBMFDefs.hpp"
+
+using namespace ibmf_defs;
+
+// Lig/kern steps of all the glyphs of a face, in an open addressed hash table
+// keyed by the (glyphCode, nextGlyphCode) pairs. Lets IBMFFontMod::ligKern()
+// find a pair with a single probe sequence instead of scanning the glyph's
+// steps. As with the scan, the first step of a glyph for a given next glyph
+// code is the one retained.
+//
+// The index is a snapshot of the steps: it must be built again once they are
+// modified.
+
+class LigKernIndex {
+private:
+    enum class Kind : uint16_t { EMPTY, LIG, KERN };
+
+    struct Entry {
+        uint32_t pair; // glyphCode << 16 | nextGlyphCode
+        Kind kind;
+        uint16_t value; // Replacement glyph code or kern
+    };
+
+    std::vector<Entry> entries_; // Power of two size, at most half used
+    std::vector<uint8_t> kinds_; // For each glyph, bit 0: has ligatures, bit 1: has kernings
+    uint32_t mask_{0};
+    int shift_{32};
+    bool built_{false};
+
+    // Index of the entry of the pair, or of the empty one where it is to be added
+    inline auto slot(uint32_t pair, Kind kind) const -> uint32_t {
+        uint32_t idx = ((pair ^ (static_cast<uint32_t>(kind) << 30)) * 0x9E3779B1U) >> shift_;
+        while ((entries_[idx].kind != Kind::EMPTY) &&
+               ((entries_[idx].pair != pair) || (entries_[idx].kind != kind))) {
+            idx = (idx + 1) & mask_;
+        }
+        return idx;
+    }
+
+    void add(GlyphCode glyphCode, GlyphCode nextGlyphCode, Kind kind, uint16_t value) {
+        uint32_t pair = (static_cast<uint32_t>(glyphCode) << 16) | nextGlyphCode;
+        Entry &entry = entries_[slot(pair, kind)];
+        if (entry.kind == Kind::EMPTY) entry = Entry{.pair = pair, .kind = kind, .value = value};
+    }
+
+    inline auto find(GlyphCode glyphCode, GlyphCode nextGlyphCode, Kind kind) const
+        -> const Entry & {
+        return entries_[slot((static_cast<uint32_t>(glyphCode) << 16) | nextGlyphCode, kind)];
+    }
+
+public:
+    inline auto built() const -> bool { return built_; }
+
+    void clear() {
+        entries_.clear();
+        entries_.shrink_to_fit();
+        kinds_.clear();
+        kinds_.shrink_to_fit();
+        mask_ = 0;
+        shift_ = 32;
+        built_ = false;
+    }
+
+    void build(const GlyphArena<GlyphLigStep> &ligSteps,
+               const GlyphArena<GlyphKernStep> &kernSteps) {
+        size_t count = 0;
+        for (size_t glyphCode = 0; glyphCode < ligSteps.size(); glyphCode++) {
+            count += ligSteps.count(glyphCode) + kernSteps.count(glyphCode);
+        }
+        size_t size = 16;
+        shift_ = 28;
+        while (size < (count * 2)) {
+            size <<= 1;
+            shift_ -= 1;
+        }
+        entries_.assign(size, Entry{.pair = 0, .kind = Kind::EMPTY, .value = 0});
+        mask_ = size - 1;
+        kinds_.assign(ligSteps.size(), 0);
+
+        for (size_t glyphCode = 0; glyphCode < ligSteps.size(); glyphCode++) {
+            kinds_[glyphCode] = ((ligSteps.count(glyphCode) > 0) ? 1 : 0) |
+                                ((kernSteps.count(glyphCode) > 0) ? 2 : 0);
+            for (auto step = ligSteps.begin(glyphCode); step != ligSteps.end(glyphCode); step++) {
+                add(glyphCode, step->nextGlyphCode, Kind::LIG, step->replacementGlyphCode);
+            }
+            for (auto step = kernSteps.begin(glyphCode); step != kernSteps.end(glyphCode); step++) {
+                add(glyphCode, step->nextGlyphCode, Kind::KERN, static_cast<uint16_t>(step->kern));
+            }
+        }
+        built_ = true;
+    }
+
+    // True if glyphCode has a ligature with nextGlyphCode
+    inline auto findLig(GlyphCode glyphCode, GlyphCode nextGlyphCode,
+                        GlyphCode &replacementGlyphCode) const -> bool {
+        if ((kinds_[glyphCode] & 1) == 0) return false;
+        const Entry &entry = find(glyphCode, nextGlyphCode, Kind::LIG);
+        replacementGlyphCode = entry.value;
+        return entry.kind != Kind::EMPTY;
+    }
+
+    // True if glyphCode has a kerning with nextGlyphCode
+    inline auto findKern(GlyphCode glyphCode, GlyphCode nextGlyphCode, FIX16 &kern) const -> bool {
+        if ((kinds_[glyphCode] & 2) == 0) return false;
+        const Entry &entry = find(glyphCode, nextGlyphCode, Kind::KERN);
+        kern = static_cast<FIX16>(entry.value);
+        return entry.kind != Kind::EMPTY;
+    }
+};
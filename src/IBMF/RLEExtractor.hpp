@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <cstring>
 #include <iostream>
@@ -8,34 +10,100 @@
 
 using namespace ibmf_defs;
 
+// For each dynF value, a table giving, for the next two nybbles of the RLE
+// data, the packed number that starts with them (lower 8 bits) and the number
+// of nybbles it takes (upper 8 bits). 0 means the number must be retrieved
+// through the general algorithm (see RLEExtractor::getPackedNumber()).
+
+constexpr auto makePackedTables() -> std::array<std::array<uint16_t, 256>, 14> {
+  std::array<std::array<uint16_t, 256>, 14> tables{};
+  for (int dynF = 0; dynF < 14; dynF++) {
+    for (int byte = 0; byte < 256; byte++) {
+      int i   = byte >> 4;
+      int nyb = byte & 0x0F;
+      if ((i == 0) || (i >= 14)) { // Large number or repeat count
+        tables[dynF][byte] = 0;
+      } else if (i <= dynF) {
+        tables[dynF][byte] = (1 << 8) | i;
+      } else {
+        tables[dynF][byte] = (2 << 8) | (((i - dynF - 1) << 4) + nyb + dynF + 1);
+      }
+    }
+  }
+  return tables;
+}
+
+// Eight bits of a non-compressed bitmap expanded to eight pixels
+constexpr auto makeExpandTable() -> std::array<uint64_t, 256> {
+  std::array<uint64_t, 256> table{};
+  for (int byte = 0; byte < 256; byte++) {
+    uint64_t pixels = 0;
+    for (int bit = 0; bit < 8; bit++) {
+      if (byte & (0x80 >> bit)) pixels |= (uint64_t)BLACK_EIGHT_BITS << (bit * 8);
+    }
+    table[byte] = pixels;
+  }
+  return table;
+}
+
 class RLEExtractor {
 private:
   uint32_t repeatCount;
 
-  MemoryPtr memoryPtr, memoryEnd;
+  static constexpr uint8_t PK_REPEAT_COUNT = 14;
+  static constexpr uint8_t PK_REPEAT_ONCE  = 15;
 
-  const uint8_t PK_REPEAT_COUNT = 14;
-  const uint8_t PK_REPEAT_ONCE  = 15;
+  static constexpr uint8_t XOR_DELTA_DYN_F = 15;
 
-  bool getnext8(uint8_t &val) {
-    if (memoryPtr >= memoryEnd) return false;
-    val = *memoryPtr++;
-    return true;
-  }
+  typedef std::array<uint16_t, 256> PackedTable;
 
-  uint8_t nybbleFlipper = 0xf0U;
-  uint8_t nybbleByte;
+  static constexpr std::array<PackedTable, 14> packedTables = makePackedTables();
+  static constexpr std::array<uint64_t, 256>  expandTable  = makeExpandTable();
 
-  bool getNybble(uint8_t &nyb) {
-    if (nybbleFlipper == 0xf0U) {
-      if (!getnext8(nybbleByte)) return false;
-      nyb = nybbleByte >> 4;
-    } else {
-      nyb = (nybbleByte & 0x0f);
+  // The RLE data is read through a 64 bits buffer, the next bits to be
+  // retrieved being the upper ones. count is the number of valid bits in the
+  // buffer. The bits below them, if any, are the following bits of the data.
+  // It is kept as a local variable of retrieveBitmap() for the compiler to
+  // hold it in registers.
+
+  struct BitReader {
+    uint64_t       bits{0};
+    int            count{0};
+    const uint8_t *ptr;
+    const uint8_t *end;
+
+    BitReader(const uint8_t *data, size_t length) : ptr(data), end(data + length) {}
+
+    inline void refill() {
+      if ((end - ptr) >= 8) {
+        uint64_t word;
+        memcpy(&word, ptr, 8);
+        bits |= __builtin_bswap64(word) >> count;
+        ptr += (63 - count) >> 3;
+        count |= 56;
+      } else {
+        while ((count <= 56) && (ptr < end)) {
+          bits |= (uint64_t)*ptr++ << (56 - count);
+          count += 8;
+        }
+      }
     }
-    nybbleFlipper ^= 0xffU;
-    return true;
-  }
+
+    inline void consume(int bitCount) {
+      bits <<= bitCount;
+      count -= bitCount;
+    }
+
+    inline bool getNybble(uint8_t &nyb) {
+      if (count < 4) {
+        refill();
+        if (count < 4) return false;
+      }
+      nyb = bits >> 60;
+      consume(4);
+      return true;
+    }
+  };
 
   // Pseudo-code:
   //
@@ -67,210 +135,463 @@ private:
   //     pk_packed_num := pk_packed_num;
   //   end;
   // end;
+  //
+  // The one and two nybbles forms are retrieved in one step through the
+  // packed table of dynF. The repeat count is retrieved in the same loop (in
+  // place of a recursive call) and is followed by the run length.
 
-  bool getPackedNumber(uint32_t &val, const RLEMetrics &rleMetrics) {
-    uint8_t  nyb;
-    uint32_t i, j;
-
-    uint8_t dynF = rleMetrics.dynF;
+  inline bool getPackedNumber(uint32_t &val, BitReader &reader, const PackedTable &table,
+                              uint8_t dynF) {
+    uint8_t   nyb;
+    uint32_t  i, j;
+    uint32_t *target = &val;
 
     while (true) {
-      if (!getNybble(nyb)) return false;
+      if (reader.count < 32) reader.refill();
+      if (reader.count >= 8) {
+        uint16_t entry = table[reader.bits >> 56];
+        if (entry != 0) {
+          reader.consume((entry >> 8) << 2);
+          *target = entry & 0xFF;
+          if (target == &val) break;
+          target = &val;
+          continue;
+        }
+      }
+      if (!reader.getNybble(nyb)) return false;
       i = nyb;
       if (i == 0) {
         do {
-          if (!getNybble(nyb)) return false;
+          if (!reader.getNybble(nyb)) return false;
           i++;
         } while (nyb == 0);
         j = nyb;
         while (i-- > 0) {
-          if (!getNybble(nyb)) return false;
+          if (!reader.getNybble(nyb)) return false;
           j = (j << 4) + nyb;
         }
-        val = j - 15 + ((13 - dynF) << 4) + dynF;
-        break;
+        *target = j - 15 + ((13 - dynF) << 4) + dynF;
       } else if (i <= dynF) {
-        val = i;
-        break;
+        *target = i;
       } else if (i < PK_REPEAT_COUNT) {
-        if (!getNybble(nyb)) return false;
-        val = ((i - dynF - 1) << 4) + nyb + dynF + 1;
-        break;
+        if (!reader.getNybble(nyb)) return false;
+        *target = ((i - dynF - 1) << 4) + nyb + dynF + 1;
       } else {
         // if (repeatCount != 0) {
         //   std::cerr << "Spurious repeatCount iteration!" << std::endl;
         //   return false;
         // }
         if (i == PK_REPEAT_COUNT) {
-          if (!getPackedNumber(repeatCount, rleMetrics)) return false;
+          target = &repeatCount;
         } else { // i == PK_REPEAT_ONCE
           repeatCount = 1;
         }
+        continue;
       }
+      if (target == &val) break;
+      target = &val;
     }
     return true;
   }
 
+  // Sets size bits of a one bit per pixel row, starting at column fromCol
+  static void setBitsOneBit(MemoryPtr line, uint32_t fromCol, uint32_t size) {
+    MemoryPtr ptr   = line + (fromCol >> 3);
+    uint32_t  first = fromCol & 7;
+    if ((first + size) <= 8) {
+      *ptr |= (uint8_t)(0xFF00U >> size) >> first;
+      return;
+    }
+    *ptr++ |= 0xFFU >> first;
+    size -= 8 - first;
+    memset(ptr, 0xFF, size >> 3);
+    ptr += size >> 3;
+    if (size & 7) *ptr |= (uint8_t)(0xFF00U >> (size & 7));
+  }
+
+  // Paints the black pixels of mask in a one bit per pixel frame buffer byte.
+  // Depending on BLACK_ONE_BIT, the bits are set or cleared.
+  static inline void paintByteOneBit(MemoryPtr ptr, uint8_t mask) {
+    if constexpr (BLACK_ONE_BIT) {
+      *ptr |= mask;
+    } else {
+      *ptr &= ~mask;
+    }
+  }
+
+  // Paints size black pixels of a one bit per pixel frame buffer row, starting
+  // at column fromCol.
+  static inline void paintBitsOneBit(MemoryPtr line, uint32_t fromCol, uint32_t size) {
+    MemoryPtr ptr   = line + (fromCol >> 3);
+    uint32_t  first = fromCol & 7;
+    if ((first + size) <= 8) {
+      paintByteOneBit(ptr, (uint8_t)(0xFF00U >> size) >> first);
+      return;
+    }
+    paintByteOneBit(ptr++, 0xFFU >> first);
+    size -= 8 - first;
+    for (; size >= 8; size -= 8) {
+      *ptr++ = BLACK_ONE_BIT ? 0xFF : 0x00;
+    }
+    if (size > 0) paintByteOneBit(ptr, (uint8_t)(0xFF00U >> size));
+  }
+
+  // Sets size pixels of an eight bits per pixel row with word stores, the last
+  // one possibly overlapping the previous one. Runs are too short for memset()
+  // to be worth its call.
+  static inline void setPixelsEightBits(MemoryPtr ptr, uint32_t size) {
+    constexpr uint64_t black64 = BLACK_EIGHT_BITS * 0x0101010101010101ULL;
+    constexpr uint32_t black32 = BLACK_EIGHT_BITS * 0x01010101U;
+    constexpr uint16_t black16 = BLACK_EIGHT_BITS * 0x0101U;
+    if (size >= 8) {
+      for (uint32_t idx = 0; idx < size - 8; idx += 8) {
+        memcpy(ptr + idx, &black64, 8);
+      }
+      memcpy(ptr + size - 8, &black64, 8);
+    } else if (size >= 4) {
+      memcpy(ptr, &black32, 4);
+      memcpy(ptr + size - 4, &black32, 4);
+    } else if (size >= 2) {
+      memcpy(ptr, &black16, 2);
+      memcpy(ptr + size - 2, &black16, 2);
+    } else {
+      *ptr = BLACK_EIGHT_BITS;
+    }
+  }
+
+  // Same for the copy of a row.
   inline void copyOneRowEightBits(MemoryPtr fromLine, MemoryPtr toLine, int16_t fromCol,
                                   int size) const {
-    memcpy(toLine + fromCol, fromLine + fromCol, size);
+    MemoryPtr from = fromLine + fromCol;
+    MemoryPtr to   = toLine + fromCol;
+    if (size >= 8) {
+      for (int idx = 0; idx < size - 8; idx += 8) {
+        memcpy(to + idx, from + idx, 8);
+      }
+      memcpy(to + size - 8, from + size - 8, 8);
+    } else {
+      for (int idx = 0; idx < size; idx++) {
+        to[idx] = from[idx];
+      }
+    }
   }
 
   void copyOneRowOneBit(MemoryPtr fromLine, MemoryPtr toLine, int16_t fromCol, int size) const {
-    uint8_t mask = 0x80 >> (fromCol & 7);
-    for (int col = fromCol; col < fromCol + size; col++) {
+    int firstByte = fromCol >> 3;
+    int lastByte  = (fromCol + size - 1) >> 3;
+    for (int idx = firstByte; idx <= lastByte; idx++) {
+      uint8_t mask = 0xFF;
+      if (idx == firstByte) mask &= 0xFFU >> (fromCol & 7);
+      if (idx == lastByte) mask &= (uint8_t)(0xFF00U >> (((fromCol + size - 1) & 7) + 1));
       if constexpr (BLACK_ONE_BIT) {
-        toLine[col >> 3] |= (fromLine[col >> 3] & mask);
+        toLine[idx] |= (fromLine[idx] & mask);
+      } else {
+        toLine[idx] &= fromLine[idx] | ~mask;
+      }
+    }
+  }
+
+  // Row-XOR delta reconstruction: each row is XORed with the previous,
+  // already reconstructed, one.
+  void undoRowDeltas(MemoryPtr rowPtr, uint32_t rowSize, uint32_t fromCol, uint32_t width,
+                     uint32_t height) const {
+    for (uint32_t row = 1; row < height; row++, rowPtr += rowSize) {
+      MemoryPtr from = rowPtr;
+      MemoryPtr to   = rowPtr + rowSize;
+      if (resolution == PixelResolution::ONE_BIT) {
+        uint32_t firstByte = fromCol >> 3;
+        uint32_t lastByte  = (fromCol + width - 1) >> 3;
+        for (uint32_t idx = firstByte; idx <= lastByte; idx++) {
+          uint8_t mask = 0xFF;
+          if (idx == firstByte) mask &= 0xFFU >> (fromCol & 7);
+          if (idx == lastByte) mask &= (uint8_t)(0xFF00U >> (((fromCol + width - 1) & 7) + 1));
+          to[idx] ^= from[idx] & mask;
+        }
       } else {
-        toLine[col >> 3] &= fromLine[col >> 3] | ~mask;
+        for (uint32_t col = fromCol; col < fromCol + width; col++) {
+          to[col] ^= from[col];
+        }
       }
-      mask >>= 1;
-      if (mask == 0) mask = 0x80;
     }
   }
 
 public:
-  bool retrieveBitmap(const RLEBitmap &fromBitmap, Bitmap &toBitmap, const Pos atOffset,
+  bool retrieveBitmap(const RLEBitmapView &fromBitmap, Bitmap &toBitmap, const Pos atOffset,
                       const RLEMetrics rleMetrics) {
+    return retrieveBitmap(fromBitmap, toBitmap.pixels.data(), toBitmap.dim, atOffset, rleMetrics);
+  }
+
+  // Same as above, the destination being toDim pixels located at toPixels
+  bool retrieveBitmap(const RLEBitmapView &fromBitmap, MemoryPtr toPixels, const Dim toDim,
+                      const Pos atOffset, const RLEMetrics rleMetrics) {
     // point on the glyphs' bitmap definition
-    memoryPtr = (MemoryPtr) fromBitmap.pixels.data();
-    memoryEnd = memoryPtr + fromBitmap.length;
+    BitReader reader(fromBitmap.data, fromBitmap.length);
     MemoryPtr toRowPtr;
 
     if ((atOffset.x < 0) || (atOffset.y < 0) ||
-        ((atOffset.y + fromBitmap.dim.height) > toBitmap.dim.height) ||
-        ((atOffset.x + fromBitmap.dim.width) > toBitmap.dim.width))
+        ((atOffset.y + fromBitmap.dim.height) > toDim.height) ||
+        ((atOffset.x + fromBitmap.dim.width) > toDim.width))
       return false;
 
-    if (resolution == PixelResolution::ONE_BIT) {
-      uint32_t toRowSize = (toBitmap.dim.width + 7) >> 3;
-      toRowPtr           = toBitmap.pixels.data() + (atOffset.y * toRowSize);
-
-      if (rleMetrics.dynF == 14) { // is a non-compressed RLE?
-        uint32_t count = 8;
-        uint8_t  data;
-
-        for (uint32_t fromRow = 0; fromRow < fromBitmap.dim.height;
-             fromRow++, toRowPtr += toRowSize) {
-          for (uint32_t toCol = atOffset.x; toCol < fromBitmap.dim.width + atOffset.x; toCol++) {
-            if (count >= 8) {
-              if (!getnext8(data)) {
-                std::cerr << "Not enough bitmap data!" << std::endl;
-                return false;
-              }
-              // std::cout << std::hex << +data << ' ';
-              count = 0;
+    const uint32_t width  = fromBitmap.dim.width;
+    const uint32_t height = fromBitmap.dim.height;
+
+    uint32_t toRowSize = (resolution == PixelResolution::ONE_BIT) ? (toDim.width + 7) >> 3
+                                                                  : toDim.width;
+    toRowPtr           = toPixels + (atOffset.y * toRowSize);
+
+    // Row-XOR delta (see BitmapCodec.hpp): the PK metrics are in the first byte
+    // of the data. The rows are reconstructed once decoded, in a region of the
+    // bitmap that must be cleared beforehand.
+    uint8_t dynF         = rleMetrics.dynF;
+    bool    firstIsBlack = rleMetrics.firstIsBlack == 1;
+    bool    xorDelta     = dynF == XOR_DELTA_DYN_F;
+
+    if (xorDelta) {
+      uint8_t metrics;
+      if (!reader.getNybble(metrics)) return false;
+      firstIsBlack = metrics & 0x01;
+      if (!reader.getNybble(dynF) || (dynF >= 14)) return false;
+    }
+
+    if (dynF == 14) { // is a non-compressed RLE?
+
+      // The pixels are retrieved eight at a time
+
+      for (uint32_t fromRow = 0; fromRow < height; fromRow++, toRowPtr += toRowSize) {
+        for (uint32_t col = 0; col < width;) {
+          uint32_t size = std::min(width - col, 8U);
+          if (reader.count < (int)size) {
+            reader.refill();
+            if (reader.count < (int)size) {
+              std::cerr << "Not enough bitmap data!" << std::endl;
+              return false;
             }
-            if (data & (0x80U >> count)) toRowPtr[toCol >> 3] |= (0x80U >> (toCol & 7));
-            count++;
           }
-        }
-        // std::cout << std::endl;
-      } else {
-        uint32_t count = 0;
-
-        repeatCount   = 0;
-        nybbleFlipper = 0xf0U;
-
-        bool black = !(rleMetrics.firstIsBlack == 1);
-
-        for (uint32_t fromRow = 0; fromRow < fromBitmap.dim.height;
-             fromRow++, toRowPtr += toRowSize) {
-          for (uint32_t toCol = atOffset.x; toCol < fromBitmap.dim.width + atOffset.x; toCol++) {
-            if (count == 0) {
-              if (!getPackedNumber(count, rleMetrics)) { return false; }
-              black = !black;
-              // if (black) {
-              //   std::cout << count << ' ';
-              // }
-              // else {
-              //   std::cout << '(' << count << ')' << ' ';
-              // }
+          uint8_t data = (reader.bits >> 56) & (0xFF00U >> size);
+          reader.consume(size);
+
+          uint32_t toCol = col + atOffset.x;
+          if (resolution == PixelResolution::ONE_BIT) {
+            toRowPtr[toCol >> 3] |= data >> (toCol & 7);
+            if (((toCol & 7) + size) > 8) toRowPtr[(toCol >> 3) + 1] |= data << (8 - (toCol & 7));
+          } else {
+            uint64_t pixels = expandTable[data];
+            if (size == 8) {
+              memcpy(toRowPtr + toCol, &pixels, 8);
+            } else {
+              memcpy(toRowPtr + toCol, &pixels, size);
             }
-            if (black) toRowPtr[toCol >> 3] |= (0x80U >> (toCol & 0x07));
-            count--;
           }
+          col += size;
+        }
+      }
+    } else {
+      const PackedTable &table = packedTables[dynF];
+
+      uint32_t count = 0;
+      repeatCount    = 0;
+
+      bool black = !firstIsBlack;
+
+      // Every run is filled as a whole, up to the end of the row
 
-          // if (repeatCount != 0) std::cout << "Repeat count: " << repeatCount
-          // << std::endl;
-          while ((fromRow < fromBitmap.dim.height) && (repeatCount-- > 0)) {
-            copyOneRowOneBit(toRowPtr, toRowPtr + toRowSize, atOffset.x, fromBitmap.dim.width);
-            fromRow++;
-            toRowPtr += toRowSize;
+      for (uint32_t fromRow = 0; fromRow < height; fromRow++, toRowPtr += toRowSize) {
+        for (uint32_t col = 0; col < width;) {
+          if (count == 0) {
+            if (!getPackedNumber(count, reader, table, dynF)) { return false; }
+            black = !black;
           }
+          uint32_t size = std::min(count, width - col);
+          if (black) {
+            if (resolution == PixelResolution::ONE_BIT) {
+              setBitsOneBit(toRowPtr, col + atOffset.x, size);
+            } else {
+              setPixelsEightBits(toRowPtr + col + atOffset.x, size);
+            }
+          }
+          col += size;
+          count -= size;
+        }
 
-          repeatCount = 0;
+        // The repeated rows are all copied from the decoded one
+        MemoryPtr decodedRowPtr = toRowPtr;
+        while (((fromRow + 1) < height) && (repeatCount > 0)) {
+          toRowPtr += toRowSize;
+          if (resolution == PixelResolution::ONE_BIT) {
+            copyOneRowOneBit(decodedRowPtr, toRowPtr, atOffset.x, width);
+          } else {
+            copyOneRowEightBits(decodedRowPtr, toRowPtr, atOffset.x, width);
+          }
+          repeatCount--;
+          fromRow++;
         }
-        // std::cout << std::endl;
+
+        repeatCount = 0;
       }
-    } else {
-      uint32_t toRowSize = toBitmap.dim.width;
-      toRowPtr           = toBitmap.pixels.data() + (atOffset.y * toRowSize);
-
-      repeatCount   = 0;
-      nybbleFlipper = 0xf0U;
-
-      if (rleMetrics.dynF == 14) { // is a bitmap?
-        uint32_t count = 8;
-        uint8_t  data;
-
-        for (uint32_t fromRow = 0; fromRow < (fromBitmap.dim.height);
-             fromRow++, toRowPtr += toRowSize) {
-          for (uint32_t toCol = atOffset.x; toCol < (fromBitmap.dim.width + atOffset.x); toCol++) {
-            if (count >= 8) {
-              if (!getnext8(data)) {
-                std::cerr << "Not enough bitmap data!" << std::endl;
-                return false;
-              }
-              // std::cout << std::hex << +data << ' ';
-              count = 0;
+    }
+
+    if (xorDelta) undoRowDeltas(toPixels + (atOffset.y * toRowSize), toRowSize,
+                                atOffset.x, width, height);
+
+    return true;
+  }
+
+public:
+  // Decodes the black pixels of the bitmap as horizontal spans, without any
+  // intermediate bitmap. They are given to the sink, in row order, through
+  // sink(row, fromCol, toCol) calls, toCol being excluded.
+  // The row-XOR delta codec is not supported.
+  template <typename Sink>
+  bool retrieveSpans(const RLEBitmapView &fromBitmap, const RLEMetrics rleMetrics, Sink &&sink) {
+    if (rleMetrics.dynF == XOR_DELTA_DYN_F) return false;
+
+    BitReader reader(fromBitmap.data, fromBitmap.length);
+
+    const uint32_t width  = fromBitmap.dim.width;
+    const uint32_t height = fromBitmap.dim.height;
+
+    if (rleMetrics.dynF == 14) { // is a non-compressed RLE?
+
+      // The spans are located in up to 56 bits at a time
+
+      for (uint32_t row = 0; row < height; row++) {
+        bool     inSpan = false;
+        uint32_t spanStart;
+        for (uint32_t col = 0; col < width;) {
+          uint32_t size = std::min(width - col, 56U);
+          if (reader.count < (int)size) {
+            reader.refill();
+            if (reader.count < (int)size) {
+              std::cerr << "Not enough bitmap data!" << std::endl;
+              return false;
             }
-            toRowPtr[toCol] = (data & (0x80U >> count)) ? 0xFF : 0;
-            count++;
           }
-        }
-        // std::cout << std::endl;
-      } else {
-        uint32_t count = 0;
-
-        repeatCount   = 0;
-        nybbleFlipper = 0xf0U;
-
-        bool black = !(rleMetrics.firstIsBlack == 1);
-
-        for (uint32_t fromRow = 0; fromRow < (fromBitmap.dim.height);
-             fromRow++, toRowPtr += toRowSize) {
-          for (uint32_t toCol = atOffset.x; toCol < (fromBitmap.dim.width + atOffset.x); toCol++) {
-            if (count == 0) {
-              if (!getPackedNumber(count, rleMetrics)) { return false; }
-              black = !black;
-              // if (black) {
-              //   std::cout << count << ' ';
-              // }
-              // else {
-              //   std::cout << '(' << count << ')' << ' ';
-              // }
+          uint64_t word = reader.bits & ~(~0ULL >> size);
+          reader.consume(size);
+
+          uint32_t offset = 0;
+          while (offset < size) {
+            if (inSpan) {
+              uint32_t ones = __builtin_clzll(~word);
+              word <<= ones;
+              offset += ones;
+              if (offset >= size) break;
+              sink(row, spanStart, col + offset);
+              inSpan = false;
+            } else {
+              if (word == 0) break;
+              uint32_t zeros = __builtin_clzll(word);
+              word <<= zeros;
+              offset += zeros;
+              spanStart = col + offset;
+              inSpan    = true;
             }
-            if (black) toRowPtr[toCol] = 0xFF;
-            count--;
           }
+          col += size;
+        }
+        if (inSpan) sink(row, spanStart, width);
+      }
+    } else {
+      const PackedTable &table = packedTables[rleMetrics.dynF];
+
+      // The spans of the current row, kept to be given again for the
+      // repeated rows
+      uint8_t  rowSpans[256];
+      uint32_t rowSpansCount;
 
-          // if (repeatCount != 0) std::cout << "Repeat count: " << repeatCount
-          // << std::endl;
-          while ((fromRow < toBitmap.dim.height) && (repeatCount-- > 0)) {
-            copyOneRowEightBits(toRowPtr, toRowPtr + toRowSize, atOffset.x, fromBitmap.dim.width);
-            fromRow++;
-            toRowPtr += toRowSize;
+      uint32_t count = 0;
+      repeatCount    = 0;
+
+      bool black = !(rleMetrics.firstIsBlack == 1);
+
+      for (uint32_t row = 0; row < height; row++) {
+        rowSpansCount = 0;
+        for (uint32_t col = 0; col < width;) {
+          if (count == 0) {
+            if (!getPackedNumber(count, reader, table, rleMetrics.dynF)) { return false; }
+            black = !black;
+          }
+          uint32_t size = std::min(count, width - col);
+          if (black) {
+            sink(row, col, col + size);
+            rowSpans[rowSpansCount++] = col;
+            rowSpans[rowSpansCount++] = col + size;
           }
+          col += size;
+          count -= size;
+        }
 
-          repeatCount = 0;
+        while (((row + 1) < height) && (repeatCount > 0)) {
+          row++;
+          for (uint32_t idx = 0; idx < rowSpansCount; idx += 2) {
+            sink(row, rowSpans[idx], rowSpans[idx + 1]);
+          }
+          repeatCount--;
         }
-        // std::cout << std::endl;
+
+        repeatCount = 0;
       }
     }
     return true;
   }
 
+  // Paints the glyph in a one bit per pixel frame buffer of width x height
+  // pixels (rows of (width + 7) / 8 bytes), its top-left corner being at
+  // (atX, atY). The parts outside of the frame buffer are clipped. The glyph's
+  // white pixels are left untouched.
+  bool blitOneBit(const RLEBitmapView &fromBitmap, const RLEMetrics rleMetrics,
+                  MemoryPtr frameBuffer, uint32_t width, uint32_t height, int32_t atX,
+                  int32_t atY) {
+    const uint32_t rowSize = (width + 7) >> 3;
+
+    const uint32_t glyphWidth  = fromBitmap.dim.width;
+    const uint32_t glyphHeight = fromBitmap.dim.height;
+
+    if ((rleMetrics.dynF == 14) && (atX >= 0) && (atY >= 0) &&
+        ((atX + glyphWidth) <= width) && ((atY + glyphHeight) <= height)) {
+
+      // A non-compressed glyph entirely inside the frame buffer: its rows are
+      // shifted in place and painted 48 bits (six bytes) at a time.
+
+      BitReader reader(fromBitmap.data, fromBitmap.length);
+      MemoryPtr line  = frameBuffer + (atY * rowSize) + (atX >> 3);
+      uint32_t  shift = atX & 7;
+
+      for (uint32_t row = 0; row < glyphHeight; row++, line += rowSize) {
+        MemoryPtr ptr = line;
+        for (uint32_t col = 0; col < glyphWidth; col += 48, ptr += 6) {
+          uint32_t size = std::min(glyphWidth - col, 48U);
+          if (reader.count < (int)size) {
+            reader.refill();
+            if (reader.count < (int)size) {
+              std::cerr << "Not enough bitmap data!" << std::endl;
+              return false;
+            }
+          }
+          uint64_t word = (reader.bits & ~(~0ULL >> size)) >> shift;
+          reader.consume(size);
+
+          uint32_t byteCount = (shift + size + 7) >> 3;
+          for (uint32_t idx = 0; idx < byteCount; idx++, word <<= 8) {
+            paintByteOneBit(ptr + idx, word >> 56);
+          }
+        }
+      }
+      return true;
+    }
+
+    return retrieveSpans(fromBitmap, rleMetrics,
+                         [&](uint32_t row, uint32_t fromCol, uint32_t toCol) {
+                           int32_t y = atY + (int32_t)row;
+                           if ((y < 0) || (y >= (int32_t)height)) return;
+                           int32_t x0 = std::max(atX + (int32_t)fromCol, 0);
+                           int32_t x1 = std::min(atX + (int32_t)toCol, (int32_t)width);
+                           if (x0 >= x1) return;
+                           paintBitsOneBit(frameBuffer + (y * rowSize), x0, x1 - x0);
+                         });
+  }
+
 public:
   RLEExtractor() {}
 };
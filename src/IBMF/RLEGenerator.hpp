@@ -26,10 +26,13 @@ public:
 
   typedef Data *DataPtr;
 
+  typedef std::vector<uint64_t> PackedRows;
+
 private:
   uint8_t value;
   bool    firstNyb;
   Data    data;
+  Data   *out; // Where the encoded bytes are sent: data or a pool (see encodeBitmap())
 
   typedef std::vector<int16_t> RepeatCounts;
   typedef int                  Chunk;
@@ -38,13 +41,34 @@ private:
   uint8_t dynF;         // = 14 if not compressed
   bool    firstIsBlack; // if compressed, true if first nibble contains black pixels
 
+  // Workspace, reused from one bitmap to the next
+  PackedRows   workRows;
+  RepeatCounts workRepeatCounts;
+  Chunks       workChunks;
+
 public:
   RLEGenerator() {
     value    = 0;
     firstNyb = true;
+    out      = &data;
     data.clear();
   }
 
+  RLEGenerator(const RLEGenerator &)                     = delete;
+  auto operator=(const RLEGenerator &) -> RLEGenerator & = delete;
+
+  // Reserves the workspace for bitmaps up to maxDim, such that no memory allocation
+  // occurs when encoding them in a presized pool.
+  void reserve(Dim maxDim) {
+    workRows.reserve(maxDim.height);
+    workRepeatCounts.reserve(maxDim.height);
+    workChunks.reserve((maxDim.width * maxDim.height) + maxDim.height + 2);
+  }
+
+  // Upper bound of the size of an encoded bitmap: the uncompressed bitmap size
+  // plus room used by putPackedRows().
+  static auto maxEncodedSize(Dim dim) -> size_t { return ((dim.width * dim.height + 7) >> 3) + 8; }
+
   uint8_t getDynF() { return dynF; }
   bool    getFirstIsBlack() { return firstIsBlack; }
   DataPtr getData() { return &data; }
@@ -74,14 +98,14 @@ public:
       value = val;
     } else {
       value = (value << 4) | val;
-      data.push_back(value);
+      out->push_back(value);
     }
     firstNyb = !firstNyb;
   }
 
   void putByte(uint8_t val) {
     value = val;
-    data.push_back(val);
+    out->push_back(val);
     firstNyb = true;
   }
 
@@ -89,7 +113,38 @@ public:
     if (!firstNyb) {
       value <<= 4;
     }
-    data.push_back(value);
+    out->push_back(value);
+    firstNyb = true;
+  }
+
+  // Sends the rows, one after the other, as a bit stream (most significant bit first).
+  // The bits of a row past its width must be 0.
+  void putPackedRows(const PackedRows &rows, int width) {
+    size_t length = ((rows.size() * width) + 7) >> 3;
+    size_t start  = out->size();
+
+    out->resize(start + length + 8); // Room for a complete last word
+    uint8_t *ptr = out->data() + start;
+
+    uint64_t acc     = 0; // Bits to be sent, from bit 63
+    int      accBits = 0;
+    for (auto bits : rows) {
+      acc |= bits >> accBits;
+      if ((accBits + width) < 64) {
+        accBits += width;
+      } else {
+        uint64_t word = __builtin_bswap64(acc);
+        memcpy(ptr, &word, 8);
+        ptr += 8;
+        int remaining = accBits + width - 64;
+        acc           = (remaining == 0) ? 0 : (bits << (width - remaining));
+        accBits       = remaining;
+      }
+    }
+    uint64_t word = __builtin_bswap64(acc);
+    memcpy(ptr, &word, 8);
+
+    out->resize(start + length);
     firstNyb = true;
   }
 
@@ -125,6 +180,105 @@ public:
   }
 #endif
 
+  // ----- Bit-packed rows -----
+  //
+  // Bitmaps up to 64 pixels wide are encoded from bit-packed rows: one 64 bits word
+  // per row, the leftmost pixel in bit 63. Identical rows are found with a single
+  // word compare and runs are located with clz on the transitions of a row (the row
+  // XORed with itself shifted by one pixel). The resulting chunks are the same as
+  // the ones of the pixel by pixel routines.
+
+  static constexpr int MAX_PACKED_WIDTH = 64;
+
+  // Packs 0x00 / 0xFF pixels, 8 at a time: the most significant bit of each byte
+  // is gathered with a multiply, the first pixel landing in the highest bit.
+  static void packRows(const BitmapPtr bitmap, PackedRows &rows) {
+    int            width  = bitmap->dim.width;
+    const uint8_t *pixels = bitmap->pixels.data();
+
+    rows.resize(bitmap->dim.height);
+    for (auto &row : rows) {
+      uint64_t bits = 0;
+      int      col  = 0;
+      for (; (col + 8) <= width; col += 8) {
+        uint64_t v;
+        memcpy(&v, pixels + col, 8);
+        v = (((v & 0x8080808080808080ULL) >> 7) * 0x8040201008040201ULL) >> 56;
+        bits |= v << (56 - col);
+      }
+      for (; col < width; col++) {
+        if (pixels[col] != 0) bits |= 1ULL << (63 - col);
+      }
+      row = bits;
+      pixels += width;
+    }
+  }
+
+  void computePackedRepeatCounts(const PackedRows &rows, int width, RepeatCounts &repeatCounts) {
+    const uint64_t mask   = ~0ULL << (64 - width);
+    const int      height = rows.size();
+
+    repeatCounts.assign(height, 0);
+
+    int row     = 0;
+    int current = 1;
+    while (current < height) {
+      if ((rows[row] == 0) || (rows[row] == mask)) {
+        // All pixels are the same, we pass the row
+        row++;
+        current++;
+      } else if (rows[row] == rows[current]) {
+        repeatCounts[row]++;
+        repeatCounts[current++] = -1;
+      } else {
+        row = current;
+        current++;
+      }
+    }
+  }
+
+  void computePackedChunks(Chunks &chunks, const PackedRows &rows, int width,
+                           const RepeatCounts &repeatCounts) {
+    const int      height = rows.size();
+    const uint64_t mask   = ~0ULL << (64 - width);
+
+    chunks.clear();
+    chunks.reserve(50);
+
+    // Value of the pixel preceding the current row, in bit 63
+    uint64_t previous = rows[0] & (1ULL << 63);
+    if (previous != 0) chunks.push_back(SET_AS_FIRST_BLACK);
+
+    int runStart = 0; // Position of the current run start, in displayed pixels
+    int rowStart = 0;
+    for (int row = 0; row < height; row++) {
+      if (repeatCounts[row] == -1) continue;
+
+      uint64_t bits        = rows[row];
+
+      // A bit is set where a pixel differs from the one on its left
+      uint64_t transitions = (bits ^ ((bits >> 1) | previous)) & mask;
+
+      if ((transitions != 0) && (repeatCounts[row] > 0)) {
+        // The repeat count follows the first run ending in the row
+        int col = __builtin_clzll(transitions);
+        chunks.push_back(rowStart + col - runStart);
+        chunks.push_back(SET_AS_REPEAT_COUNT(repeatCounts[row]));
+        runStart = rowStart + col;
+        transitions &= ~(1ULL << (63 - col));
+      }
+      while (transitions != 0) {
+        int col = __builtin_clzll(transitions);
+        chunks.push_back(rowStart + col - runStart);
+        runStart = rowStart + col;
+        transitions &= ~(1ULL << (63 - col));
+      }
+      rowStart += width;
+      previous = (bits << (width - 1)) & (1ULL << 63);
+    }
+    chunks.push_back(rowStart - runStart);
+  }
+
   void computeChunks(Chunks &chunks, const BitmapPtr bitmap, const RepeatCounts &repeatCounts) {
     chunks.clear();
     chunks.reserve(50);
@@ -208,6 +362,76 @@ public:
 
     if ((bitmap->dim.height * bitmap->dim.width) == 0) return false;
 
+    if (bitmap->dim.width > MAX_PACKED_WIDTH) return encodePixels(bitmap);
+
+    packRows(bitmap, workRows);
+    computePackedRepeatCounts(workRows, bitmap->dim.width, workRepeatCounts);
+    computePackedChunks(workChunks, workRows, bitmap->dim.width, workRepeatCounts);
+
+    return encodeChunks(workChunks, bitmap->dim, &workRows);
+  }
+
+  // Same as encodeBitmap(), the encoded bytes being appended to the pool instead of
+  // the generator data. With a pool presized with maxEncodedSize() and a workspace
+  // presized with reserve(), no memory allocation occurs.
+  bool encodeBitmap(const BitmapPtr bitmap, Data &pool) {
+    out         = &pool;
+    firstNyb    = true;
+    bool result = encodeBitmap(bitmap);
+    out         = &data;
+    return result;
+  }
+
+  // Bitmap encoding from bit-packed rows (see packRows()). dim.width must not be
+  // greater than MAX_PACKED_WIDTH.
+  bool encodeRows(const PackedRows &rows, Dim dim) {
+
+    if ((dim.height * dim.width) == 0) return false;
+
+    computePackedRepeatCounts(rows, dim.width, workRepeatCounts);
+    computePackedChunks(workChunks, rows, dim.width, workRepeatCounts);
+
+    return encodeChunks(workChunks, dim, &rows);
+  }
+
+  // Uncompressed bitmap (dynF == 14) from bit-packed rows, whatever the size of
+  // its compressed form. The encoded bytes are appended to the pool.
+  bool encodeRawRows(const PackedRows &rows, Dim dim, Data &pool) {
+
+    if ((dim.height * dim.width) == 0) return false;
+
+    dynF         = 14;
+    firstIsBlack = false;
+    out          = &pool;
+    putPackedRows(rows, dim.width);
+    out = &data;
+    return true;
+  }
+
+  // Same as encodeRows(), the encoded bytes being appended to the pool.
+  bool encodeRows(const PackedRows &rows, Dim dim, Data &pool) {
+    out         = &pool;
+    firstNyb    = true;
+    bool result = encodeRows(rows, dim);
+    out         = &data;
+    return result;
+  }
+
+  // Bitmap encoding, pixel by pixel. Used for bitmaps wider than MAX_PACKED_WIDTH.
+  bool encodePixels(const BitmapPtr bitmap) {
+
+    if ((bitmap->dim.height * bitmap->dim.width) == 0) return false;
+
+    computeRepeatCounts(bitmap, workRepeatCounts);
+    computeChunks(workChunks, bitmap, workRepeatCounts);
+
+    return encodeChunks(workChunks, bitmap->dim);
+  }
+
+  // When the bit-packed rows are supplied, an uncompressed bitmap (dynF == 14) is
+  // sent directly from them.
+  bool encodeChunks(const Chunks &chunks, Dim dim, const PackedRows *rows = nullptr) {
+
     int compSize = 0;
     int deriv[14]; // index 1..13 are used
 
@@ -215,14 +439,7 @@ public:
 
     // compute compression size and dynF
 
-    RepeatCounts repeatCounts;
-    Chunks       chunks;
-
-    computeRepeatCounts(bitmap, repeatCounts);
-    computeChunks(chunks, bitmap, repeatCounts);
-
 #if DEBUG
-    showRepeatCounts(repeatCounts);
     showChunks(chunks);
 #endif
 
@@ -280,12 +497,12 @@ public:
     }
 
     compSize = (bCompSize + 1) >> 1;
-    if ((compSize > ((bitmap->dim.height * bitmap->dim.width + 7) >> 3))) {
-      compSize = (bitmap->dim.height * bitmap->dim.width + 7) >> 3;
+    if ((compSize > ((dim.height * dim.width + 7) >> 3))) {
+      compSize = (dim.height * dim.width + 7) >> 3;
       dynF     = 14;
     }
 
-    data.reserve(compSize);
+    out->reserve(out->size() + compSize);
 
 #if DEBUG
     std::cout << "Best packing is dynF of " << dynF << " with length " << compSize << "."
@@ -336,6 +553,11 @@ public:
         }
       }
       if (!firstNyb) putRemainder();
+    } else if (rows != nullptr) {
+
+      // ---- Send bit map from the packed rows ----
+
+      putPackedRows(*rows, dim.width);
     } else {
 
       // ---- Send bit map (rle uncompressed format) ----
@@ -345,7 +567,7 @@ public:
       int     i          = 1; // index in the chunks list
       int     rI         = 0;
       int     sI         = 0;
-      int     hBit       = bitmap->dim.width;
+      int     hBit       = dim.width;
       bool    on         = false; // true if it's for black pixels
       bool    rOn        = false;
       bool    sOn        = false;
@@ -404,14 +626,14 @@ public:
             }
             count -= hBit;
             pBit -= hBit;
-            hBit = bitmap->dim.width;
+            hBit = dim.width;
             if (pBit == 0) {
               putByte(buff);
               buff = 0;
               pBit = 8;
             }
           }
-        } while (hBit != bitmap->dim.width);
+        } while (hBit != dim.width);
 
         if (repeating && (repeatFlag == 0)) {
           count     = sCount;
@@ -0,0 +1,114 @@
+#include "UnifontStore.hpp"
+
+#include <cstring>
+#include <fstream>
+
+auto UnifontStore::open(const std::string &filename) -> bool {
+  close();
+
+  if (!file_.open(filename)) return false;
+
+  if (file_.size() < sizeof(Header)) {
+    log_e("File too small to be a glyph store: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  const Header *header = reinterpret_cast<const Header *>(file_.data());
+  if (strncmp("UGS1", header->marker, 4) != 0) {
+    log_e("Not a glyph store: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  if ((header->glyphsOffset + ((uint64_t)header->glyphCount * sizeof(Glyph))) > file_.size()) {
+    log_e("Truncated glyph store: %s", filename.c_str());
+    close();
+    return false;
+  }
+
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    uint32_t offset = header->planeIndexOffsets[i];
+    if (offset == 0) continue;
+    if ((offset + (PLANE_SIZE * sizeof(uint32_t))) > file_.size()) {
+      log_e("Truncated glyph store: %s", filename.c_str());
+      close();
+      return false;
+    }
+    planeIndexes_[i] = reinterpret_cast<const uint32_t *>(file_.data() + offset);
+  }
+
+  glyphs_ = reinterpret_cast<const Glyph *>(file_.data() + header->glyphsOffset);
+  header_ = header;
+
+  return true;
+}
+
+void UnifontStore::close() {
+  file_.close();
+  header_ = nullptr;
+  glyphs_ = nullptr;
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    planeIndexes_[i] = nullptr;
+  }
+}
+
+auto UnifontStore::addGlyph(char32_t codePoint, const Glyph &glyph, bool wide) -> bool {
+  uint32_t planeIdx = codePoint >> 16;
+  if (planeIdx >= PLANES_COUNT) return false;
+
+  if (buildIndexes_[planeIdx].empty()) {
+    buildIndexes_[planeIdx].resize(PLANE_SIZE, NO_SLOT);
+  }
+
+  uint32_t &entry = buildIndexes_[planeIdx][codePoint & 0xFFFF];
+  if (entry == NO_SLOT) {
+    entry = buildGlyphs_.size();
+    buildGlyphs_.push_back(glyph);
+  } else { // Duplicate codePoint: the last definition is retained
+    entry &= ~WIDE_GLYPH;
+    buildGlyphs_[entry] = glyph;
+  }
+  if (wide) entry |= WIDE_GLYPH;
+
+  return true;
+}
+
+auto UnifontStore::save(const std::string &filename) -> bool {
+  std::fstream out;
+  out.open(filename, std::ios::out | std::ios::binary);
+
+  if (!out.is_open()) {
+    log_e("Unable to create glyph store: %s", filename.c_str());
+    return false;
+  }
+
+  Header header;
+  memcpy(header.marker, "UGS1", 4);
+  header.glyphCount = buildGlyphs_.size();
+  header.filler     = 0;
+
+  uint32_t offset   = sizeof(Header);
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    if (buildIndexes_[i].empty()) {
+      header.planeIndexOffsets[i] = 0;
+    } else {
+      header.planeIndexOffsets[i] = offset;
+      offset += PLANE_SIZE * sizeof(uint32_t);
+    }
+  }
+  header.glyphsOffset = offset;
+
+  out.write((char *)&header, sizeof(Header));
+  for (int i = 0; i < PLANES_COUNT; i++) {
+    if (!buildIndexes_[i].empty()) {
+      out.write((char *)buildIndexes_[i].data(), PLANE_SIZE * sizeof(uint32_t));
+    }
+  }
+  out.write((char *)buildGlyphs_.data(), buildGlyphs_.size() * sizeof(Glyph));
+
+  bool result = out.good();
+  out.close();
+
+  return result;
+}
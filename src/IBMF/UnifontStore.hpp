@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "../Misc/MappedFile.hpp"
+
+// clang-format off
+//
+// Pre-compiled binary version of a GNU Unifont hex file. It is built once from the
+// hex file (see IBMFHexImport::compileHex()) and memory mapped at generation time such
+// that only the glyphs required by a book are accessed.
+//
+//  At Offset 0:
+//  +--------------------+
+//  |                    |  Header (32 bytes)
+//  +--------------------+
+//  |                    |  For each plane present (planeIndexOffsets[plane] != 0):
+//  |                    |  65536 32 bits entries giving the glyph slot of each
+//  |                    |  codePoint of the plane (NO_SLOT if absent). The WIDE_GLYPH bit
+//  |                    |  is set for 16 pixels wide glyphs.
+//  +--------------------+
+//  |                    |  Glyph slots: 16 rows of 16 bits each, left aligned (bit 15 is
+//  |                    |  the leftmost pixel; 8 pixels wide glyphs only use bits 15..8)
+//  +--------------------+
+//
+// clang-format on
+
+class UnifontStore {
+public:
+#pragma pack(push, 1)
+  struct Header {
+    char     marker[4]; // "UGS1"
+    uint32_t glyphCount;
+    uint32_t planeIndexOffsets[4];
+    uint32_t glyphsOffset;
+    uint32_t filler;
+  };
+
+  struct Glyph {
+    uint16_t rows[16];
+  };
+#pragma pack(pop)
+
+  static constexpr uint32_t NO_SLOT      = 0xFFFFFFFF;
+  static constexpr uint32_t WIDE_GLYPH   = 0x80000000;
+  static constexpr int      PLANE_SIZE   = 65536;
+  static constexpr int      PLANES_COUNT = 4;
+
+private:
+  MappedFile          file_;
+  const Header       *header_{nullptr};
+  const uint32_t     *planeIndexes_[PLANES_COUNT]{nullptr, nullptr, nullptr, nullptr};
+  const Glyph        *glyphs_{nullptr};
+
+  // Used only when building a store
+  std::vector<uint32_t> buildIndexes_[PLANES_COUNT];
+  std::vector<Glyph>    buildGlyphs_;
+
+public:
+  UnifontStore() = default;
+
+  auto open(const std::string &filename) -> bool;
+  void close();
+  inline auto isOpen() const -> bool { return header_ != nullptr; }
+
+  // Retrieves the glyph associated with a codePoint. Returns false if absent.
+  inline auto getGlyph(char32_t codePoint, const Glyph *&glyph, bool &wide) const -> bool {
+    uint32_t planeIdx = codePoint >> 16;
+    if ((planeIdx >= PLANES_COUNT) || (planeIndexes_[planeIdx] == nullptr)) return false;
+    uint32_t slot = planeIndexes_[planeIdx][codePoint & 0xFFFF];
+    if (slot == NO_SLOT) return false;
+    wide  = (slot & WIDE_GLYPH) != 0;
+    glyph = &glyphs_[slot & ~WIDE_GLYPH];
+    return true;
+  }
+
+  // Store construction
+  auto addGlyph(char32_t codePoint, const Glyph &glyph, bool wide) -> bool;
+  auto save(const std::string &filename) -> bool;
+};
@@ -0,0 +1,151 @@
+#include "GzLineReader.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// miniz is configured without default allocators (MINIZ_NO_MALLOC)
+static auto gzAlloc(void *opaque, size_t items, size_t size) -> void * {
+    return malloc(items * size);
+}
+
+static void gzFree(void *opaque, void *address) { free(address); }
+
+static inline auto le32(const uint8_t *p) -> uint32_t {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+auto GzLineReader::open(const uint8_t *data, size_t size, size_t bufferSize) -> bool {
+    static constexpr int FHCRC = 0x02;
+    static constexpr int FEXTRA = 0x04;
+    static constexpr int FNAME = 0x08;
+    static constexpr int FCOMMENT = 0x10;
+
+    close();
+
+    const uint8_t *in = data;
+    inEnd_ = data + size;
+
+    // ----- Header -----
+
+    if ((size < 18) || (in[0] != 0x1F) || (in[1] != 0x8B) || (in[2] != 8)) {
+        return failure("Not a gzip compressed file.");
+    }
+
+    int flags = in[3];
+    in += 10;
+    if (flags & FEXTRA) {
+        in += 2 + (in[0] | (in[1] << 8));
+    }
+    if (flags & FNAME) {
+        while ((in < inEnd_) && (*in != 0)) in++;
+        in++;
+    }
+    if (flags & FCOMMENT) {
+        while ((in < inEnd_) && (*in != 0)) in++;
+        in++;
+    }
+    if (flags & FHCRC) in += 2;
+
+    if ((in > inEnd_) || ((inEnd_ - in) < 8)) {
+        return failure("Truncated gzip file.");
+    }
+
+    // ----- Deflate stream -----
+
+    memset(&stream_, 0, sizeof(stream_));
+    stream_.zalloc = gzAlloc;
+    stream_.zfree = gzFree;
+    if (mz_inflateInit2(&stream_, -MZ_DEFAULT_WINDOW_BITS) != MZ_OK) {
+        return failure("Unable to initialize gzip decompression.");
+    }
+    streamInit_ = true;
+
+    stream_.next_in = in;
+    stream_.avail_in = inEnd_ - in;
+
+    buffer_.resize(bufferSize);
+    crc_ = MZ_CRC32_INIT;
+
+    return true;
+}
+
+void GzLineReader::close() {
+    if (streamInit_) {
+        mz_inflateEnd(&stream_);
+        streamInit_ = false;
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    completed_ = false;
+    failed_ = false;
+    kept_ = 0;
+    pending_ = 0;
+    length_ = 0;
+}
+
+auto GzLineReader::failure(const char *msg) -> bool {
+    log_e("%s", msg);
+    failed_ = true;
+    completed_ = true;
+    if (streamInit_) {
+        mz_inflateEnd(&stream_);
+        streamInit_ = false;
+    }
+    return false;
+}
+
+auto GzLineReader::checkTrailer() -> bool {
+    const uint8_t *trailer = stream_.next_in;
+    if (((inEnd_ - trailer) < 8) || (le32(trailer) != crc_) || (le32(trailer + 4) != length_)) {
+        return failure("Corrupted gzip file.");
+    }
+    return true;
+}
+
+auto GzLineReader::nextLines(const char *&begin, const char *&end) -> bool {
+    if (completed_) return false;
+
+    // The lines given at the previous call are consumed
+    kept_ -= pending_;
+    memmove(buffer_.data(), buffer_.data() + pending_, kept_);
+    pending_ = 0;
+
+    while (true) {
+        stream_.next_out = reinterpret_cast<unsigned char *>(buffer_.data() + kept_);
+        stream_.avail_out = buffer_.size() - kept_;
+
+        int status = mz_inflate(&stream_, MZ_NO_FLUSH);
+        if ((status != MZ_OK) && (status != MZ_STREAM_END)) {
+            return failure("Gzip decompression error.");
+        }
+
+        size_t filled = buffer_.size() - stream_.avail_out;
+        crc_ = mz2_crc32(crc_, reinterpret_cast<const uint8_t *>(buffer_.data() + kept_),
+                         filled - kept_);
+        length_ += filled - kept_;
+        kept_ = filled;
+
+        begin = buffer_.data();
+
+        if (status == MZ_STREAM_END) {
+            completed_ = true;
+            mz_inflateEnd(&stream_);
+            streamInit_ = false;
+            if (!checkTrailer()) return false;
+            end = begin + filled;
+            pending_ = filled;
+            return filled > 0;
+        }
+
+        const char *eol = static_cast<const char *>(memrchr(begin, '\n', filled));
+        if (eol != nullptr) {
+            end = eol + 1;
+            pending_ = end - begin;
+            return true;
+        }
+        if (filled == buffer_.size()) {
+            return failure("Line too long in gzip file.");
+        }
+        // Waiting for more data
+    }
+}
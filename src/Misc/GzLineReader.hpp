@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+#include "log.hpp"
+#include "miniz.h"
+
+// Streaming decompression of a gzip (RFC 1952) compressed text file that is
+// present in memory (usually a MappedFile). The text is retrieved in blocks of
+// complete lines, the decompressed content never being present in memory as a
+// whole: the part of a line at the end of a block is carried over to the next one.
+
+class GzLineReader {
+private:
+    mz_stream stream_;
+    bool streamInit_{false};
+    bool completed_{false};
+    bool failed_{false};
+
+    const uint8_t *inEnd_{nullptr};
+    std::vector<char> buffer_;
+    size_t kept_{0};    // Size of the incomplete line at the beginning of the buffer
+    size_t pending_{0}; // Size of the lines given to the caller at the last nextLines() call
+    uint32_t crc_{0};
+    uint32_t length_{0};
+
+    auto failure(const char *msg) -> bool;
+    auto checkTrailer() -> bool;
+
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    GzLineReader() = default;
+    ~GzLineReader() { close(); }
+
+    GzLineReader(const GzLineReader &) = delete;
+    auto operator=(const GzLineReader &) -> GzLineReader & = delete;
+
+    // The data must stay available until close() is called. bufferSize limits the
+    // length of a line.
+    auto open(const uint8_t *data, size_t size, size_t bufferSize = DEFAULT_BUFFER_SIZE) -> bool;
+    void close();
+
+    // Retrieves the next block of complete lines (the last line of the file may be
+    // without end of line). The block stays valid up to the next call. Returns false
+    // at the end of the file or on error (see failed()).
+    auto nextLines(const char *&begin, const char *&end) -> bool;
+
+    [[nodiscard]] inline auto failed() const -> bool { return failed_; }
+};
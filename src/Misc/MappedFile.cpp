@@ -0,0 +1,49 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+auto MappedFile::open(const std::string &filePath, bool sequential) -> bool {
+    close();
+
+    fd_ = ::open(filePath.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+        log_e("Unable to open file: %s", filePath.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        log_e("Unable to retrieve file size: %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+    size_ = st.st_size;
+    if (size_ > 0) {
+        void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (addr == MAP_FAILED) {
+            log_e("Unable to map file: %s", filePath.c_str());
+            close();
+            return false;
+        }
+        madvise(addr, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        data_ = (const uint8_t *)addr;
+    }
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        munmap((void *)data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
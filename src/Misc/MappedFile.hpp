@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+
+#include "log.hpp"
+
+// Read-only memory mapping of a complete file. The content stays valid
+// until close() is called or the instance is destroyed. The sequential flag
+// tells the kernel how the content will be accessed (read ahead or not).
+
+class MappedFile {
+private:
+    const uint8_t *data_{nullptr};
+    size_t size_{0};
+    int fd_{-1};
+
+public:
+    MappedFile() = default;
+    MappedFile(const std::string &filePath, bool sequential = true) { open(filePath, sequential); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+    auto open(const std::string &filePath, bool sequential = true) -> bool;
+    void close();
+
+    [[nodiscard]] inline auto isOpen() const -> bool { return fd_ != -1; }
+    [[nodiscard]] inline auto data() const -> const uint8_t * { return data_; }
+    [[nodiscard]] inline auto size() const -> size_t { return size_; }
+    [[nodiscard]] inline auto begin() const -> const char * { return (const char *)data_; }
+    [[nodiscard]] inline auto end() const -> const char * { return (const char *)data_ + size_; }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Resolves a requested thread count: 0 means one thread per hardware core.
+inline auto threadCountFor(int requested) -> int {
+    if (requested > 0) return requested;
+    int cores = std::thread::hardware_concurrency();
+    return (cores > 0) ? cores : 1;
+}
+
+// Runs fn(idx) for each idx in [0, count) using a pool of up to threadCount
+// workers. Indexes are handed out dynamically, in increasing order, such that
+// uneven work items are balanced. The calling thread is one of the workers.
+// fn must not throw.
+template <typename Fn> void parallelFor(size_t count, int threadCount, Fn fn) {
+    threadCount = std::min<size_t>(std::max(threadCount, 1), count);
+
+    if (threadCount <= 1) {
+        for (size_t idx = 0; idx < count; idx++) {
+            fn(idx);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        size_t idx;
+        while ((idx = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+            fn(idx);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &w : workers) {
+        w.join();
+    }
+}
@@ -1,10 +1,12 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <thread>
 
 #include "EPub/EPubFile.hpp"
 #include "IBMF/IBMFHexImport.hpp"
 #include "IBMF/UTF8Iterator.hpp"
+#include "Misc/StringUtil.hpp"
 
 using CharsList = std::map<char32_t, uint32_t>;
 using TransList = std::map<char32_t, char32_t>;
@@ -193,27 +195,127 @@ auto ScanDocument() -> bool {
 }
 
 void Usage(const char *path) {
-  std::cout << "Usage: " << path << " <HEX Font Path> <EPub file path>" << std::endl;
+  std::cout << "Usage: " << path
+            << " [-t <threads>] [-e <codec>] [-x] <HEX Font Path>... <EPub file path>"
+            << std::endl
+            << "       " << path
+            << " [-t <threads>] <Glyph Store or Glyph Pack Path> <EPub file path>" << std::endl
+            << "       " << path << " -c <HEX Font Path> <Glyph Store Path>" << std::endl
+            << "       " << path << " -p <HEX Font Path> <Glyph Pack Path>" << std::endl
+            << std::endl
+            << "The -c option compiles the HEX Font into a Glyph Store (.ugs) that" << std::endl
+            << "can then be used in place of the HEX Font to speedup generation." << std::endl
+            << "The -p option compiles the HEX Font into a Glyph Pack (.ugp) of" << std::endl
+            << "pre-encoded glyphs: no glyph encoding is then done at generation." << std::endl
+            << "When more than one HEX Font is given, they are merged, the glyphs of" << std::endl
+            << "the last ones taking precedence." << std::endl
+            << "The -t option sets the number of threads used to read the HEX Font" << std::endl
+            << "and to encode the glyphs (0: one per core, default: 1)." << std::endl
+            << "The -e option (experimental) selects the glyph encoding per glyph:" << std::endl
+            << "size (smallest), decode (fastest to decode) or raw (no compression)." << std::endl
+            << "The -x option (experimental) allows the row-XOR delta encoding with" << std::endl
+            << "-e size or -e decode. Such fonts are not supported by IBMF readers." << std::endl;
 }
 
 auto main(int argc, char **argv) -> int {
 
-  int status = 0;
+  int  status  = 0;
+  bool compile = false;
+  bool pack    = false;
+  int  argIdx  = 1;
+
+  CodecOptions codecOptions;
+
+  while ((argIdx < argc) && (argv[argIdx][0] == '-')) {
+    if (strcmp(argv[argIdx], "-c") == 0) {
+      compile = true;
+      argIdx += 1;
+    } else if (strcmp(argv[argIdx], "-p") == 0) {
+      pack = true;
+      argIdx += 1;
+    } else if ((strcmp(argv[argIdx], "-t") == 0) && ((argIdx + 1) < argc)) {
+      ibmfHexImport.setThreadCount(atoi(argv[argIdx + 1]));
+      argIdx += 2;
+    } else if ((strcmp(argv[argIdx], "-e") == 0) && ((argIdx + 1) < argc)) {
+      const char *codec = argv[argIdx + 1];
+      if (strcmp(codec, "size") == 0) {
+        codecOptions.policy = CodecPolicy::MIN_SIZE;
+      } else if (strcmp(codec, "decode") == 0) {
+        codecOptions.policy = CodecPolicy::MIN_DECODE;
+      } else if (strcmp(codec, "raw") == 0) {
+        codecOptions.policy = CodecPolicy::RAW;
+      } else {
+        Usage(argv[0]);
+        return -1;
+      }
+      argIdx += 2;
+    } else if (strcmp(argv[argIdx], "-x") == 0) {
+      codecOptions.xorDelta = true;
+      argIdx += 1;
+    } else {
+      Usage(argv[0]);
+      return -1;
+    }
+  }
 
-  if (argc != 3) {
+  if (((argc - argIdx) < 2) || ((compile || pack) && ((argc - argIdx) != 2))) {
       Usage(argv[0]);
       return -1;
   }
 
-  ePubFile = std::make_shared<EPubFile>(argv[2]);
+  ibmfHexImport.setCodecOptions(codecOptions);
+
+  std::vector<std::string> fontPaths(argv + argIdx, argv + argc - 1);
+
+  const char *fontPath = argv[argIdx];
+  const char *ePubPath = argv[argc - 1];
+
+  if (compile) {
+    return ibmfHexImport.compileHex(fontPath, ePubPath) ? 0 : -3;
+  }
+
+  if (pack) {
+    return ibmfHexImport.compilePack(fontPath, ePubPath) ? 0 : -3;
+  }
+
+  bool hexFile = !HasSuffix(fontPath, ".ugs") && !HasSuffix(fontPath, ".ugp");
+
+  if (!hexFile && (fontPaths.size() > 1)) {
+    Usage(argv[0]);
+    return -1;
+  }
+
+  // The hex files are parsed in the background while the book is being scanned.
+  // The glyphs are selected once both are completed.
+  bool        parsed = false;
+  std::thread hexParser;
+
+  if (hexFile) {
+    hexParser = std::thread([&]() { parsed = ibmfHexImport.parseHexSources(fontPaths); });
+  }
+
+  ePubFile = std::make_shared<EPubFile>(ePubPath);
+
+  bool scanned = false;
+  if (ePubFile->isOpen()) {
+    log_i("File %s is open", ePubPath);
+    scanned = ScanDocument();
+  }
+
+  if (hexParser.joinable()) hexParser.join();
 
   if (ePubFile->isOpen()) {
-    log_i("File %s is open", argv[2]);
-    if (ScanDocument()) {
+    if (scanned) {
       log_i("Scan completed! Characters Count: %" PRIu32, (uint32_t)charsList.size());
       ShowCharsList();
       BuildUBlocks();
-      ibmfHexImport.loadHex(argv[1], myUBlocks);
+      if (HasSuffix(fontPath, ".ugs")) {
+        ibmfHexImport.loadStore(fontPath, myUBlocks);
+      } else if (HasSuffix(fontPath, ".ugp")) {
+        ibmfHexImport.loadPack(fontPath, myUBlocks);
+      } else if (parsed) {
+        ibmfHexImport.selectHex(myUBlocks);
+      }
 
       std::fstream out;
       out.open("font.ibmf", std::ios::out);
@@ -228,7 +330,7 @@ auto main(int argc, char **argv) -> int {
       log_e("Unable to complete document scan");
     }
   } else {
-    log_e("Unable to open file %s", argv[2]);
+    log_e("Unable to open file %s", ePubPath);
     status = -2;
   }
 